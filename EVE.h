@@ -110,7 +110,7 @@ enum class MemoryMap : uint32_t
     Flash_Size          = EVE_EXT_FLASH_SIZE, /* defined in EVE_config.h */
     RAM_PNG_BUFFER_SIZE = 0x00A800UL,         /* If the loading image is in PNG format, the top 42K bytes from address 0xF5800 of RAM_G will \
         be overwritten as temporary data buffer for decoding process.  */
-    RAM_G_SAFETY_SIZE   = RAM_G_Size - RAM_PNG_BUFFER_SIZE - 1,
+    RAM_G_SAFETY_SIZE   = RAM_G_Size - RAM_PNG_BUFFER_SIZE,
 
     //Memory end
     RAM_G_end   = RAM_G + RAM_G_Size,
@@ -451,6 +451,16 @@ enum class TextOpt : uint16_t
     Fill     = 8192
 };
 
+enum class NumberOpt : uint16_t
+{
+    NoCenter = 0,
+    Signed   = 256,
+    CenterX  = 512,
+    CenterY  = 1024,
+    CenterXY = CenterX | CenterY,
+    RightX   = 2048
+};
+
 enum class ButtonOpt : uint16_t
 {
     _3D  = 0,
@@ -770,7 +780,7 @@ static constexpr uint32_t bitmapLayout(BitmapFormats format,
 #define BITMAP_SIZE(filter, wrapx, wrapy, width, height) ((8UL << 24) | (((filter)&1UL) << 20) | (((wrapx)&1UL) << 19) | (((wrapy)&1UL) << 18) | (((width)&511UL) << 9) | (((height)&511UL) << 0))
 static constexpr uint32_t bitmapSize(BitmapFilter filter,
                                      BitmapWrap   wrapx,
-                                     BitmapFilter wrapy,
+                                     BitmapWrap   wrapy,
                                      uint16_t     width,
                                      uint16_t     height)
 {
@@ -861,6 +871,10 @@ static constexpr uint32_t call(uint32_t dest)
     return ((29UL << 24) | (((dest)&65535UL) << 0));
 }
 #define CELL(cell)     ((6UL << 24) | (((cell)&127UL) << 0))
+static constexpr uint32_t cell(uint8_t c)
+{
+    return ((6UL << 24) | (((c)&127UL) << 0));
+}
 #define CLEAR(c, s, t) ((38UL << 24) | (((c)&1UL) << 2) | (((s)&1UL) << 1) | (((t)&1UL) << 0))
 static constexpr uint32_t clear(bool c, bool t, bool s)
 {
@@ -1028,7 +1042,8 @@ static constexpr uint32_t vertex2ii(uint16_t x,
     #define EVE_RAM_FLASH_POSTBLOB  0x801000UL
     #define EVE_RAM_PNG_BUFFER_SIZE 0x00A800UL /* If the loading image is in PNG format, the top 42K bytes from address 0xF5800 of RAM_G will \
     be overwritten as temporary data buffer for decoding process.  */
-    #define EVE_RAM_G_SAFETY_SIZE (EVE_RAM_G_SIZE) - EVE_RAM_PNG_BUFFER_SIZE - 1
+    #define EVE_RAM_PNG_BUFFER      0x0F5800UL /* start of PNG decoding buffer */
+    #define EVE_RAM_G_SAFETY_SIZE   ((EVE_RAM_G_SIZE) - EVE_RAM_PNG_BUFFER_SIZE)
 
     #define EVE_OPT_FLASH  64UL
     #define EVE_OPT_FORMAT 4096UL
@@ -1118,12 +1133,18 @@ static constexpr uint32_t bitmapSwizzle(SwizzleSource r,
 }
     #if defined(BT81X_ENABLE)
 //        #define BITMAP_SOURCE2(flash_or_ram, addr) ((1UL << 24) | ((flash_or_ram) << 23) | (((addr)&8388607UL) << 0))
+/* Flash address is set in 32 byte blocks with bit 23 */
 static constexpr uint32_t bitmapSource(MemoryMap targetMemory,
                                        uint32_t  addr)
 {
-    return ((1UL << 24)
-            | (static_cast<uint8_t>(targetMemory) << 23)
-            | (((addr)&8388607UL) << 0));
+    return targetMemory == MemoryMap::Flash
+               ? ((1UL << 24) | (1UL << 23) | (((addr) >> 5) & 8388607UL))
+               : ((1UL << 24) | (((addr)&4194303UL) << 0));
+}
+/* Source address of bitmap in flash for CMD_SETBITMAP */
+static constexpr uint32_t flashSource(uint32_t addr)
+{
+    return (1UL << 23) | (addr >> 5);
 }
     #else
 //        #define BITMAP_SOURCE(addr) ((1UL << 24) | (((addr)&4194303UL) << 0))
@@ -1335,11 +1356,23 @@ static constexpr uint32_t bitmapSizeH(uint16_t width, uint16_t height)
 
     //#define NOP() ((45UL<<24))
     #define PALETTE_SOURCE(addr)        ((42UL << 24) | (((addr)&4194303UL) << 0))
+static constexpr uint32_t paletteSource(uint32_t addr)
+{
+    return ((42UL << 24) | (((addr)&4194303UL) << 0));
+}
     #define SCISSOR_SIZE(width, height) ((28UL << 24) | (((width)&4095UL) << 12) | (((height)&4095UL) << 0))
     #define SCISSOR_XY(x, y)            ((27UL << 24) | (((x)&2047UL) << 11) | (((y)&2047UL) << 0))
     #define VERTEX_FORMAT(frac)         ((39UL << 24) | (((frac)&7UL) << 0))
     #define VERTEX_TRANSLATE_X(x)       ((43UL << 24) | (((x)&131071UL) << 0))
+static constexpr uint32_t vertexTranslateX(int32_t x)
+{
+    return ((43UL << 24) | (((x)&131071UL) << 0));
+}
     #define VERTEX_TRANSLATE_Y(y)       ((44UL << 24) | (((y)&131071UL) << 0))
+static constexpr uint32_t vertexTranslateY(int32_t y)
+{
+    return ((44UL << 24) | (((y)&131071UL) << 0));
+}
 
 /* ----------------- FT80x exclusive definitions -----------------*/
 #else
@@ -126,6 +126,20 @@ uint32_t EVE_HAL::rd32(uint32_t address)
     return data;
 }
 
+void EVE_HAL::rdByteBuffer(uint32_t address, uint8_t * buffer, uint16_t len)
+{
+    csSet();
+    m_spi.write(static_cast<uint8_t>((address >> 16) | MEM_READ));
+    m_spi.write(static_cast<uint8_t>(address >> 8));
+    m_spi.write(static_cast<uint8_t>(address));
+    m_spi.write(0x00);
+    for(uint16_t count = 0; count < len; count++)
+    {
+        buffer[count] = static_cast<uint8_t>(m_spi.write(0x00));
+    }
+    csClear();
+}
+
 void EVE_HAL::wr8(uint32_t address, uint8_t data)
 {
     csSet();
@@ -173,16 +187,17 @@ void EVE_HAL::wrByteBuffer(uint32_t address, const std::vector<uint8_t> & buffer
 
 void EVE_HAL::wrByteBuffer(uint32_t address, const uint8_t * buffer, uint16_t len)
 {
-    uint16_t count;
-    len = (len + 3) & (~3);
+    uint32_t count;
+    //Data padded with zeros to 4 bytes
+    uint32_t padded = (len + 3) & (~3);
 
     csSet();
     m_spi.write(static_cast<uint8_t>((address >> 16) | MEM_WRITE));
     m_spi.write(static_cast<uint8_t>(address >> 8));
     m_spi.write(static_cast<uint8_t>(address));
-    for(count = 0; count < len; count++)
+    for(count = 0; count < padded; count++)
     {
-        m_spi.write(static_cast<uint8_t>(*buffer + count));
+        m_spi.write(count < len ? buffer[count] : 0);
     }
     csClear();
 }
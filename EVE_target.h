@@ -79,6 +79,10 @@ public:
     uint8_t  rd8(uint32_t address);
     uint16_t rd16(uint32_t address);
     uint32_t rd32(uint32_t address);
+    /*!
+     * \brief rdByteBuffer - burst read of memory block in one SPI transaction
+     */
+    void rdByteBuffer(uint32_t address, uint8_t * buffer, uint16_t len);
 
     void wr8(uint32_t address, uint8_t data);
     void wr16(uint32_t address, uint16_t data);
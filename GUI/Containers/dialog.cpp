@@ -10,6 +10,7 @@ Dialog::Dialog(Widget * parent) :
     m_y      = 0;
     m_width  = EVE_HSIZE;
     m_height = EVE_VSIZE;
+    updateBounds();
 
     m_scrim       = new Scrim(this);
     m_contentItem = new Page(this);
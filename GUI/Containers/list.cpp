@@ -96,12 +96,18 @@ void List::setVisibleItemCount(const uint16_t & visibleItemCount)
                       : m_visibleItemCount;
 }
 
+bool List::interactive() const
+{
+    return m_scrollable || Widget::interactive();
+}
+
 bool List::touchPressed(int16_t x, int16_t y)
 {
     if(Widget::touchPressed(x, y))
     {
         if(!m_scrollable)
             return true;
+        setDragging(true);
         switch(m_orientation)
         {
         case FTGUI::List::Vertical:
@@ -178,7 +184,10 @@ bool List::touchReleased(int16_t x,
             {
                 int16_t diff = abs(m_contentItem->x() % m_contentItem->m_container.front()->width());
                 if(diff == 0)
+                {
+                    setDragging(false);
                     return true;
+                }
                 if(diff < (m_contentItem->m_container.front()->width() / 2))
                 {
                     if(accelerationX > -10)
@@ -228,7 +237,10 @@ bool List::touchReleased(int16_t x,
             {
                 int16_t diff = abs(m_contentItem->y() % m_contentItem->m_container.front()->height());
                 if(diff == 0)
+                {
+                    setDragging(false);
                     return true;
+                }
                 if(diff < (m_contentItem->m_container.front()->height() / 2))
                 {
                     if(accelerationY > -10)
@@ -267,6 +279,8 @@ bool List::touchReleased(int16_t x,
             break;
         }
     }
+    //Settling animation keeps content floating till it ends
+    setDragging(false);
     return false;
 }
 
@@ -324,6 +338,25 @@ bool List::scrollable() const
 void List::setScrollable(bool scrollable)
 {
     m_scrollable = scrollable;
+    if(scrollable == false)
+        setDragging(false);
+}
+
+void List::setDragging(bool dragging)
+{
+    if(m_dragging == dragging)
+        return;
+    m_dragging = dragging;
+    //Drag holds content floating like position animation
+    if(dragging)
+    {
+        if(m_contentItem->m_moving++ == 0)
+            m_contentItem->setFloating(true);
+    }
+    else
+    {
+        m_contentItem->positionLanded();
+    }
 }
 
 }    // namespace FTGUI
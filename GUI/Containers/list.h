@@ -53,11 +53,18 @@ public:
     void     setIndex(uint16_t index);
     uint16_t index() const;
 
+protected:
+    bool interactive() const override;
+
 private:
+    //Dragged content is not indexed, it is indexed once after drag and settling animation
+    void setDragging(bool dragging);
+
     Orientation                     m_orientation{Horizontal};
     uint16_t                        m_visibleItemCount{0}, m_itemCount{0}, m_index{0};
     uint16_t                        m_prevPosition{0};
     bool                            m_scrollable{true};
+    bool                            m_dragging{false};
     Widget *                        m_contentItem{nullptr};
     std::function<void(uint16_t)> * m_onIndexChanged{nullptr};
 };
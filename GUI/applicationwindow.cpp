@@ -39,6 +39,8 @@ ApplicationWindow::ApplicationWindow(Theme *           theme,
                          EVE_PD,
                          EVE_INTRPT);
 
+    m_index = new SpatialIndex(EVE_HSIZE, EVE_VSIZE);
+
     m_queue = new EventQueue(96 * EVENTS_EVENT_SIZE);
     m_thread.start(mbed::callback(m_queue, &EventQueue::dispatch_forever));
     m_orientation = screenOrientation;
@@ -56,13 +58,24 @@ ApplicationWindow::ApplicationWindow(Theme *           theme,
     //set touch callbacks
     m_driver->attachTouchDetectedCallback([&](uint8_t) {
         FT8xx::CmdBuf_t xy = m_driver->touchXY();
-        m_xFifo.push_back(xy.halfWord[1]);
-        m_yFifo.push_back(xy.halfWord[0]);
+        m_touchFilter.push(xy.halfWord[1], xy.halfWord[0]);
         m_touchPressed = true;
     });
 
     m_driver->attachTouchConversionsCallback([&](uint8_t) {
-        FT8xx::CmdBuf_t xy = m_driver->touchXY();
+        FT8xx::CmdBuf_t xy;
+#if defined(FT81X_ENABLE)
+        if(m_multiTouch)
+        {
+            //Primary point is taken from the same burst
+            int16_t x[MaxTouchPoints], y[MaxTouchPoints];
+            uint8_t mask = m_driver->touchPoints(x, y);
+            multiTouch(mask, x, y);
+            xy = FT8xx::CmdBuf_t(y[0], x[0]);
+        }
+        else
+#endif
+            xy = m_driver->touchXY();
         //        debug("XY: %i:%i\n", xy.halfWord[1], xy.halfWord[0]);
         //NOTE: Check filtering parameters after assembly!!!
         if(xy.word == (int32_t)0x80008000)
@@ -74,8 +87,7 @@ ApplicationWindow::ApplicationWindow(Theme *           theme,
                            accY = m_accelerationY]() {
                 touchReleased(x, y, accX, accY);
             });
-            m_xFifo.clear();
-            m_yFifo.clear();
+            m_touchFilter.reset();
             m_accelerationTicker.detach();
             m_accelerationX = 0;
             m_accelerationY = 0;
@@ -84,34 +96,14 @@ ApplicationWindow::ApplicationWindow(Theme *           theme,
             return;
         }
 
-        m_xFifo.push_back(xy.halfWord[1]);
-        m_yFifo.push_back(xy.halfWord[0]);
-
-        if(m_xFifo.size() > 12)
+        if(m_touchFilter.push(xy.halfWord[1], xy.halfWord[0]))
         {
-            std::sort(m_xFifo.begin(),
-                      m_xFifo.end());
-            std::sort(m_yFifo.begin(),
-                      m_yFifo.end());
-
-            m_xFifo.pop_front();
-            m_yFifo.pop_front();
-            m_xFifo.pop_front();
-            m_yFifo.pop_front();
-            m_xFifo.pop_front();
-            m_yFifo.pop_front();
-
-            m_xFifo.pop_back();
-            m_yFifo.pop_back();
-            m_xFifo.pop_back();
-            m_yFifo.pop_back();
-            m_xFifo.pop_back();
-            m_yFifo.pop_back();
-
+            int16_t x = m_touchFilter.x();
+            int16_t y = m_touchFilter.y();
             if(m_touchPressed)
             {
-                m_prevX = m_xFifo[3];
-                m_prevY = m_yFifo[3];
+                m_prevX = x;
+                m_prevY = y;
                 m_queue->call([&, x = m_prevX, y = m_prevY]() {
                     touchPressed(x, y);
                     m_accelerationTicker.attach(callback(this, &ApplicationWindow::deceleration), 0.1);
@@ -121,16 +113,15 @@ ApplicationWindow::ApplicationWindow(Theme *           theme,
             }
 
             //check if touch point changed
-            if(abs(m_prevX - m_xFifo[3]) > 1
-               || abs(m_prevY - m_yFifo[3]) > 1)
+            if(abs(m_prevX - x) > 1
+               || abs(m_prevY - y) > 1)
             {
-                m_accelerationX = m_xFifo[3] - m_prevX;
-                m_accelerationY = m_yFifo[3] - m_prevY;
-                //                debug("prev XY: %i:%i .. %i:%i\n", m_xFifo[3], m_prevX, m_prevY, m_yFifo[3]);
+                m_accelerationX = x - m_prevX;
+                m_accelerationY = y - m_prevY;
                 //                debug("Accl XY: %i:%i\n", m_accelerationX, m_accelerationY);
 
-                m_prevX = m_xFifo[3];
-                m_prevY = m_yFifo[3];
+                m_prevX = x;
+                m_prevY = y;
                 m_queue->call([&, x = m_prevX, y = m_prevY]() {
                     touchChanged(x,
                                  y,
@@ -151,6 +142,12 @@ ApplicationWindow::~ApplicationWindow()
     {
         delete w;
     }
+    //Children free their Ram_G objects and tags with driver, so they go before it
+    for(auto w : m_container)
+    {
+        delete w;
+    }
+    m_container.clear();
     delete m_theme;
     delete m_driver;
     delete m_queue;
@@ -183,7 +180,8 @@ void ApplicationWindow::show()
                 m_driver->dlStart();
                 m_driver->clearColorRGB(m_theme->background().hex());
                 m_driver->clear();
-                w->show();
+                showChild(w);
+                releaseHiddenTags();
                 m_driver->swap();
                 m_driver->execute();
                 m_renderLock = false;
@@ -199,6 +197,7 @@ void ApplicationWindow::show()
     m_driver->clearColorRGB(m_theme->background().hex());
     m_driver->clear();
     Widget::show();
+    releaseHiddenTags();
     m_driver->swap();
     m_driver->execute();
     m_renderLock = false;
@@ -236,8 +235,162 @@ void ApplicationWindow::removeWidget(Widget * widget)
     }
 }
 
+void ApplicationWindow::setMultiTouch(bool enable)
+{
+#if defined(FT81X_ENABLE)
+    m_driver->setExtendedTouch(enable);
+    m_multiTouch = enable;
+#endif
+}
+
+GestureRecognizer & ApplicationWindow::gestureRecognizer()
+{
+    return m_gestureRecognizer;
+}
+
+void ApplicationWindow::multiTouch(uint8_t mask, const int16_t * x, const int16_t * y)
+{
+    //Event is lost when GUI queue is full, so state is changed only for queued ones and the rest is tried again
+    auto post = [this](uint8_t finger, TouchPhase phase, int16_t px, int16_t py) {
+        return m_queue->call([this, finger, phase, px, py]() {
+            touchPoint(finger, phase, px, py);
+        }) != 0;
+    };
+    //Moves are sent with cadence of touch filter latency, not with conversion rate
+    bool cadence = ++m_multiTouchTick >= m_touchFilter.latency();
+    if(cadence)
+        m_multiTouchTick = 0;
+
+    for(uint8_t i = 0; i < MaxTouchPoints; ++i)
+    {
+        uint8_t bit = 1 << i;
+        if((mask & bit) != 0)
+        {
+            if((m_fingers & bit) == 0)
+            {
+                if(post(i, TouchPhase::Pressed, x[i], y[i]) == false)
+                    continue;
+                m_fingers |= bit;
+            }
+            else if(x[i] != m_fingerX[i] || y[i] != m_fingerY[i])
+            {
+                m_fingersMoved |= bit;
+            }
+            m_fingerX[i] = x[i];
+            m_fingerY[i] = y[i];
+            if(cadence
+               && (m_fingersMoved & bit) != 0
+               && post(i, TouchPhase::Moved, x[i], y[i]))
+                m_fingersMoved &= ~bit;
+        }
+        //Release carries last position, so pending move is dropped
+        else if((m_fingers & bit) != 0
+                && post(i, TouchPhase::Released, m_fingerX[i], m_fingerY[i]))
+        {
+            m_fingers &= ~bit;
+            m_fingersMoved &= ~bit;
+        }
+    }
+
+    if(m_gestureRecognizer.update(mask, x, y, static_cast<uint32_t>(Kernel::get_ms_count())))
+    {
+        const Gesture & g = m_gestureRecognizer.gesture();
+        //Scroll deltas of coalesced events are summed, pinch scale is absolute
+        if(m_gesturePending
+           && g.type == Gesture::Scroll
+           && m_pendingGesture.type == Gesture::Scroll)
+        {
+            int16_t dx          = m_pendingGesture.dx + g.dx;
+            int16_t dy          = m_pendingGesture.dy + g.dy;
+            m_pendingGesture    = g;
+            m_pendingGesture.dx = dx;
+            m_pendingGesture.dy = dy;
+        }
+        else
+        {
+            m_pendingGesture = g;
+        }
+        m_gesturePending = true;
+    }
+    //Long press and last movement before two finger gesture ends are not delayed
+    bool urgent = m_pendingGesture.type == Gesture::LongPress || (mask & (mask - 1)) == 0;
+    if(m_gesturePending
+       && (cadence || urgent)
+       && m_queue->call([this, g = m_pendingGesture]() { gesture(g); }) != 0)
+        m_gesturePending = false;
+}
+
+TouchFilter & ApplicationWindow::touchFilter()
+{
+    return m_touchFilter;
+}
+
+void ApplicationWindow::setTagHitTest(bool enable)
+{
+    Widget::setTagHitTest(enable);
+    for(const auto & w : m_modalContainer)
+    {
+        w->setTagHitTest(enable);
+    }
+}
+
+void ApplicationWindow::registerTag(Widget * widget)
+{
+    if(m_tagsFull)
+        return;
+    uint8_t tag = m_tagCount < TagLimit ? m_driver->allocateTag() : 0;
+    if(tag == 0)
+    {
+        m_tagsFull = true;
+        return;
+    }
+    widget->m_tag     = tag;
+    m_tagTargets[tag] = widget;
+    ++m_tagCount;
+}
+
+void ApplicationWindow::unregisterTag(Widget * widget)
+{
+    m_tagTargets[widget->m_tag] = nullptr;
+    m_driver->deattachFromTag(widget->m_tag);
+    widget->m_tag = 0;
+    --m_tagCount;
+    m_tagsFull = false;
+    if(m_touchTarget == widget)
+        m_touchTarget = nullptr;
+}
+
+void ApplicationWindow::releaseHiddenTags()
+{
+    if(m_tagCount == 0)
+        return;
+    for(auto w : m_tagTargets)
+    {
+        if(w != nullptr && w->m_tagFrame != m_driver->frame())
+            unregisterTag(w);
+    }
+}
+
+Widget * ApplicationWindow::tagTarget()
+{
+    if(m_tagHitTest == false)
+        return nullptr;
+    Widget * target = m_tagTargets[m_driver->touchTag()];
+    //Outer tagged widget handles touches of its subtree itself, f.e. scrolled list
+    for(auto w = target; w != nullptr && w != this; w = w->m_parent)
+    {
+        if(w->m_tag != 0)
+            target = w;
+    }
+    return target;
+}
+
 bool ApplicationWindow::touchPressed(int16_t x, int16_t y)
 {
+    //Touch is captured by tagged widget till release
+    m_touchTarget = tagTarget();
+    if(m_touchTarget)
+        return m_touchTarget->touchPressed(x, y);
     if(m_modalOpened)
     {
         for(const auto & w : m_modalContainer)
@@ -256,6 +409,8 @@ bool ApplicationWindow::touchChanged(int16_t         x,
                                      const int16_t * accelerationX,
                                      const int16_t * accelerationY)
 {
+    if(m_touchTarget)
+        return m_touchTarget->touchChanged(x, y, accelerationX, accelerationY);
     if(m_modalOpened)
     {
         for(const auto & w : m_modalContainer)
@@ -274,6 +429,12 @@ bool ApplicationWindow::touchReleased(int16_t x,
                                       int16_t accelerationX,
                                       int16_t accelerationY)
 {
+    if(m_touchTarget)
+    {
+        auto target   = m_touchTarget;
+        m_touchTarget = nullptr;
+        return target->touchReleased(x, y, accelerationX, accelerationY);
+    }
     if(m_modalOpened)
     {
         for(const auto & w : m_modalContainer)
@@ -287,6 +448,36 @@ bool ApplicationWindow::touchReleased(int16_t x,
     }
 }
 
+bool ApplicationWindow::touchPoint(uint8_t    finger,
+                                   TouchPhase phase,
+                                   int16_t    x,
+                                   int16_t    y)
+{
+    if(m_modalOpened)
+    {
+        for(const auto & w : m_modalContainer)
+        {
+            w->touchPoint(finger, phase, x, y);
+        }
+        return true;
+    }
+    return Widget::touchPoint(finger, phase, x, y);
+}
+
+bool ApplicationWindow::gesture(const Gesture & gesture)
+{
+    if(m_modalOpened)
+    {
+        for(const auto & w : m_modalContainer)
+        {
+            if(w->gesture(gesture))
+                return true;
+        }
+        return false;
+    }
+    return Widget::gesture(gesture);
+}
+
 void ApplicationWindow::animationStarted(void *   value,
                                          uint32_t duration,
                                          uint8_t  delay)
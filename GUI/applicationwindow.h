@@ -26,8 +26,8 @@
 #define APPLICATIONWINDOW_H
 
 #include <Containers/dialog.h>
-#include <deque>
 #include <graphics.h>
+#include <touchfilter.h>
 #include <widget.h>
 
 namespace FTGUI
@@ -47,16 +47,44 @@ public:
 
     void removeWidget(Widget * widget) override;
 
+    /*!
+     * \brief setTagHitTest - dispatch touch by EVE tags, modal widgets included
+     */
+    void setTagHitTest(bool enable);
+
+    /*!
+     * \brief touchFilter - filter of touch samples, window and latency may be changed for panel
+     */
+    TouchFilter & touchFilter();
+
+    /*!
+     * \brief setMultiTouch - read all touch points of capacitive panel (FT5x06, GT911) in extended mode.
+     * Fingers are routed by touchPoint and gestures are recognized. Primary finger works as before
+     */
+    void                setMultiTouch(bool enable);
+    GestureRecognizer & gestureRecognizer();
+
 protected:
     bool touchPressed(int16_t x, int16_t y) override;
     bool touchChanged(int16_t x, int16_t y, const int16_t * accelerationX, const int16_t * accelerationY) override;
     bool touchReleased(int16_t x, int16_t y, int16_t accelerationX, int16_t accelerationY) override;
+    bool touchPoint(uint8_t finger, TouchPhase phase, int16_t x, int16_t y) override;
+    bool gesture(const Gesture & gesture) override;
 
     void animationStarted(void *   value,
                           uint32_t duration = Duration,
                           uint8_t  delay    = Delay) override;
     void update() override;
 
+    void registerTag(Widget * widget) override;
+    void unregisterTag(Widget * widget) override;
+    //Release tags of widgets not drawn with them in last frame (hidden, culled or removed from shown tree)
+    void releaseHiddenTags();
+    //Tagged widget under touch point, nullptr - use geometric search
+    Widget * tagTarget();
+    //Route finger changes and feed gesture recognizer
+    void multiTouch(uint8_t mask, const int16_t * x, const int16_t * y);
+
     LowPowerTicker m_accelerationTicker;
 
     void deceleration()
@@ -81,12 +109,29 @@ protected:
         m_accelerationY{0};
 
     std::vector<ModalWidget *> m_modalContainer;
+    //Widgets indexed by EVE tag. Hit test takes at most TagLimit tags, rest is kept for driver callbacks
+    static constexpr uint8_t TagLimit = 128;
+    Widget *                 m_tagTargets[256]{};
+    Widget *                 m_touchTarget{nullptr};
+    uint8_t                  m_tagCount{0};
+    //Allocation failed, not retried until some tag is released
+    bool m_tagsFull{false};
 
-    std::deque<int16_t> m_xFifo;
-    std::deque<int16_t> m_yFifo;
-    uint8_t             m_animationCounter{0};
-    int32_t             m_updateEventId{0};
-    Thread              m_thread{osPriorityNormal, (3 * 1024), nullptr, "GUIThread"};
+    TouchFilter       m_touchFilter;
+    GestureRecognizer m_gestureRecognizer;
+    bool              m_multiTouch{false};
+    //Fingers which press is queued, fingers moved since last queued move
+    uint8_t m_fingers{0},
+        m_fingersMoved{0},
+        m_multiTouchTick{0};
+    int16_t m_fingerX[MaxTouchPoints]{},
+        m_fingerY[MaxTouchPoints]{};
+    //Gesture coalesced till next cadence tick
+    Gesture m_pendingGesture{};
+    bool    m_gesturePending{false};
+    uint8_t     m_animationCounter{0};
+    int32_t     m_updateEventId{0};
+    Thread      m_thread{osPriorityNormal, (3 * 1024), nullptr, "GUIThread"};
 };
 }    // namespace FTGUI
 
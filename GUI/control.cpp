@@ -90,6 +90,11 @@ bool Button::touchReleased(int16_t x,
     return false;
 }
 
+bool Button::interactive() const
+{
+    return m_enabled;
+}
+
 bool Button::checkable() const
 {
     return m_checkable;
@@ -75,6 +75,8 @@ public:
                                int16_t accelerationY) override;
 
 protected:
+    bool interactive() const override;
+
     Label *     m_label{nullptr};
     Rectangle * m_checker{nullptr};
     bool        m_enabled{true},
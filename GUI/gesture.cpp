@@ -0,0 +1,163 @@
+/*!
+ * @file gesture.cpp
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "gesture.h"
+
+#include <stdlib.h>
+
+namespace FTGUI
+{
+bool GestureRecognizer::update(uint8_t       mask,
+                               const int16_t x[MaxTouchPoints],
+                               const int16_t y[MaxTouchPoints],
+                               uint32_t      time)
+{
+    //Two first fingers present
+    uint8_t fingers[2];
+    uint8_t count = 0;
+    for(uint8_t i = 0; i < MaxTouchPoints; ++i)
+    {
+        if(mask & (1 << i))
+        {
+            if(count < 2)
+                fingers[count] = i;
+            ++count;
+        }
+    }
+
+    if(count == 0)
+    {
+        m_state = Idle;
+        return false;
+    }
+
+    if(count == 1)
+    {
+        uint8_t f = fingers[0];
+        if(m_state != OneFinger && m_state != LongPressed)
+        {
+            m_state     = OneFinger;
+            m_startTime = time;
+            m_startX    = x[f];
+            m_startY    = y[f];
+            return false;
+        }
+        if(m_state == LongPressed)
+            return false;
+        if(abs(x[f] - m_startX) > m_slop
+           || abs(y[f] - m_startY) > m_slop)
+        {
+            //Finger moved, it is not long press anymore, restart from here
+            m_startTime = time;
+            m_startX    = x[f];
+            m_startY    = y[f];
+            return false;
+        }
+        if(time - m_startTime < m_longPressTime)
+            return false;
+        m_state   = LongPressed;
+        m_gesture = {Gesture::LongPress, m_startX, m_startY, 256, 0, 0};
+        return true;
+    }
+
+    uint8_t  a       = fingers[0];
+    uint8_t  b       = fingers[1];
+    int16_t  centerX = (x[a] + x[b]) / 2;
+    int16_t  centerY = (y[a] + y[b]) / 2;
+    uint32_t d       = distance(x[b] - x[a], y[b] - y[a]);
+    if(m_state != TwoFingers && m_state != Pinching && m_state != Scrolling)
+    {
+        m_state         = TwoFingers;
+        m_centerX       = centerX;
+        m_centerY       = centerY;
+        m_startDistance = d != 0 ? d : 1;
+        return false;
+    }
+    if(m_state == TwoFingers)
+    {
+        if(abs(static_cast<int32_t>(d - m_startDistance)) > m_slop)
+            m_state = Pinching;
+        else if(abs(centerX - m_centerX) > m_slop
+                || abs(centerY - m_centerY) > m_slop)
+            m_state = Scrolling;
+        else
+            return false;
+    }
+    if(m_state == Pinching)
+    {
+        uint32_t scale = (d * 256 + m_startDistance / 2) / m_startDistance;
+        m_gesture      = {Gesture::Pinch,
+                     centerX,
+                     centerY,
+                     static_cast<uint16_t>(scale > 0xFFFF ? 0xFFFF : scale),
+                     0,
+                     0};
+        return true;
+    }
+    if(centerX == m_centerX && centerY == m_centerY)
+        return false;
+    m_gesture = {Gesture::Scroll,
+                 centerX,
+                 centerY,
+                 256,
+                 static_cast<int16_t>(centerX - m_centerX),
+                 static_cast<int16_t>(centerY - m_centerY)};
+    m_centerX = centerX;
+    m_centerY = centerY;
+    return true;
+}
+
+const Gesture & GestureRecognizer::gesture() const
+{
+    return m_gesture;
+}
+
+void GestureRecognizer::setLongPressTime(uint16_t ms)
+{
+    m_longPressTime = ms;
+}
+
+void GestureRecognizer::setSlop(uint8_t pixels)
+{
+    m_slop = pixels;
+}
+
+uint32_t GestureRecognizer::distance(int32_t dx, int32_t dy)
+{
+    //Integer square root, screen distances fit 16 bit
+    uint32_t value = static_cast<uint32_t>(dx * dx + dy * dy);
+    uint32_t root  = 0;
+    for(uint32_t bit = 1u << 30; bit != 0; bit >>= 2)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+    }
+    return root;
+}
+}    // namespace FTGUI
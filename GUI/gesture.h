@@ -0,0 +1,111 @@
+/*!
+ * @file gesture.h
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+
+namespace FTGUI
+{
+static constexpr uint8_t MaxTouchPoints = 5;
+
+enum class TouchPhase : uint8_t
+{
+    Pressed,
+    Moved,
+    Released
+};
+
+struct Gesture
+{
+    enum Type : uint8_t
+    {
+        LongPress,
+        Pinch,
+        Scroll    //Two finger scroll
+    };
+    Type type;
+    //Point under gesture, center between fingers for two finger gestures
+    int16_t x;
+    int16_t y;
+    //Pinch: distance between fingers to distance at start, 256 - 1.0
+    uint16_t scale;
+    //Scroll: movement of center since previous event
+    int16_t dx;
+    int16_t dy;
+};
+
+/*!
+ * \brief GestureRecognizer - detect long press, pinch and two finger scroll from touch points.
+ * It is fed with every touch conversion. Two finger gesture is locked to pinch or scroll
+ * by what exceeds slop first, till one of fingers is released
+ */
+class GestureRecognizer
+{
+public:
+    /*!
+     * \brief update - process touch points
+     * \param mask - bit per finger present in points
+     * \param x, y - coordinates of touch points
+     * \param time - time of conversion in ms
+     * \return true if gesture event is ready
+     */
+    bool update(uint8_t       mask,
+                const int16_t x[MaxTouchPoints],
+                const int16_t y[MaxTouchPoints],
+                uint32_t      time);
+
+    const Gesture & gesture() const;
+
+    void setLongPressTime(uint16_t ms);
+    void setSlop(uint8_t pixels);
+
+private:
+    enum State : uint8_t
+    {
+        Idle,
+        OneFinger,
+        LongPressed,
+        TwoFingers,
+        Pinching,
+        Scrolling
+    };
+
+    Gesture  m_gesture{};
+    State    m_state{Idle};
+    uint16_t m_longPressTime{600};
+    uint8_t  m_slop{12};
+    uint32_t m_startTime{0};
+    int16_t  m_startX{0},
+        m_startY{0},
+        m_centerX{0},
+        m_centerY{0};
+    uint32_t m_startDistance{0};
+
+    static uint32_t distance(int32_t dx, int32_t dy);
+};
+}    // namespace FTGUI
+
+#endif    // GESTURE_H
@@ -214,87 +214,220 @@ void Label::show()
 {
     if(checkPositionInScreen() == false)
         return;
+    updateLayout();
     m_driver->colorARGB(m_color.hexa());
     m_driver->push(BLEND_FUNC(EVE_SRC_ALPHA, EVE_ONE_MINUS_SRC_ALPHA));
-    //TODO: Add font scaling to target size
-    //    EVE_cmd_dl(CMD_LOADIDENTITY);
-    //    EVE_cmd_scale(65536 / 2, 65536 / 2);
-    //    EVE_cmd_dl(CMD_SETMATRIX);
-    if(m_fillWidth == true)
+
+    auto font = m_font.customFont();
+    if(font != nullptr)
     {
-        m_driver->push(CMD_FILLWIDTH);
-        m_driver->push(m_width);
-        if(m_verticalAlignment == Bottom)
-        {
-            m_driver->text(absX(),
-                           absY() - m_font.fontHeight(),
-                           m_font.fontNumber(),
-                           m_text.c_str(),
-                           TextOpt::Fill);
-        }
-        else
+        m_driver->setFont(font);
+        m_driver->ramG()->requireGlyphs(font, m_text);
+    }
+    //Static label replays glyphs recorded on first show
+    if(m_fragment != nullptr)
+    {
+        m_driver->append(m_fragment,
+                         absX() - m_fragmentX,
+                         absY() - m_fragmentY);
+        Widget::show();
+        return;
+    }
+    if(m_recordedEmpty)
+    {
+        Widget::show();
+        return;
+    }
+    //Paged glyphs may be moved, so they are not recorded
+    bool     record = m_static && m_recordFailed == false && m_driver->ramG() != nullptr
+                  && (font == nullptr || font->paged() == false);
+    uint16_t start  = record ? m_driver->dlOffset() : 0;
+
+    //Lines are broken on host, so CoPro draws them without CMD_FILLWIDTH
+    int32_t y = absY();
+    if(m_verticalAlignment == Bottom)
+        y -= m_font.scaled(m_layout.height());
+    else if(m_verticalAlignment == VCenter)
+        y -= m_font.scaled(m_layout.height()) / 2;
+    if(m_font.isScaled())
+    {
+        drawScaled(y);
+    }
+    else
+    {
+        for(const auto & line : m_layout.lines())
         {
             m_driver->text(absX(),
-                           absY(),
+                           y,
                            m_font.fontNumber(),
-                           m_text.c_str(),
-                           TextOpt::Fill /*static_cast<TextOpt>(m_verticalAlignment | m_horizontalAlignment)*/);
+                           line.text.data(),
+                           line.text.size(),
+                           static_cast<TextOpt>(m_horizontalAlignment));
+            y += m_layout.lineHeight();
         }
     }
-    else
+    if(record)
     {
-        if(m_verticalAlignment == Bottom)
+        auto ramG = m_driver->ramG();
+        //Recording is only a cache, full Ram_G must not stop drawing
+        if(static_cast<uint16_t>(m_driver->dlOffset() - start) > ramG->freeSpace())
         {
-            m_driver->text(absX(),
-                           absY() - m_font.fontHeight(),
-                           m_font.fontNumber(),
-                           m_text.c_str(),
-                           static_cast<TextOpt>(Top | m_horizontalAlignment));
+            m_recordFailed = true;
         }
         else
         {
-            m_driver->text(absX(),
-                           absY(),
-                           m_font.fontNumber(),
-                           m_text.c_str(),
-                           static_cast<TextOpt>(m_verticalAlignment | m_horizontalAlignment));
+            m_fragment      = ramG->saveFragment(m_name, start);
+            m_fragmentX     = absX();
+            m_fragmentY     = absY();
+            m_recordedEmpty = m_fragment == nullptr;
         }
     }
     Widget::show();
 }
 
-Label::Label(string   text,
-             int32_t  x,
-             int32_t  y,
-             uint16_t width,
-             uint16_t height,
-             Widget * parent) :
-    Widget(parent),
-    m_text(text)
+void Label::drawScaled(int32_t y)
 {
-    m_name = "Label";
-    m_x    = x;
-    m_y    = y;
-    if(width == 0 && text.length() != 0)
+    //Glyph cell enlarged to target size, matrix is calculated by LFont
+    uint16_t cellWidth  = m_font.scaled(m_font.nativeWidth());
+    uint16_t cellHeight = m_font.fontHeight();
+    m_driver->bitmapHandle(m_font.fontNumber());
+    m_driver->push(bitmapSize(Bilinear, Border, Border, cellWidth, cellHeight));
+    m_driver->push(bitmapSizeH(cellWidth, cellHeight));
+    m_driver->push(m_font.transformA());
+    m_driver->push(m_font.transformE());
+    m_driver->begin(Bitmaps);
+    for(const auto & line : m_layout.lines())
     {
-        for(const auto & c : text)
+        int32_t x = absX();
+        if(m_horizontalAlignment == HCenter)
+            x -= m_font.scaled(line.width) / 2;
+        else if(m_horizontalAlignment == Right)
+            x -= m_font.scaled(line.width);
+        //Position is scaled from native advance, so rounding doesn't accumulate
+        uint16_t advance = 0;
+        for(auto c : line.text)
         {
-            m_width += m_font.charWidth(c);
+            if(c != ' ')
+            {
+                m_driver->push(cell(static_cast<uint8_t>(c)));
+                m_driver->vertexPointF(x + m_font.scaled(advance), y);
+            }
+            advance += m_font.charWidth(c);
         }
+        y += cellHeight;
     }
-    else
-    {
-        m_width = width;
-    }
+    m_driver->end();
+    //Font handle and matrix are shared with other text
+    m_driver->push(bitmapTransformA(256));
+    m_driver->push(bitmapTransformE(256));
+    m_driver->push(bitmapSize(Nearest, Border, Border, m_font.nativeWidth(), m_font.nativeHeight()));
+    m_driver->push(bitmapSizeH(m_font.nativeWidth(), m_font.nativeHeight()));
+}
 
-    if(height == 0)
+Label::~Label()
+{
+    dropFragment();
+}
+
+bool Label::isStatic() const
+{
+    return m_static;
+}
+
+void Label::setStatic(bool isStatic)
+{
+    m_static = isStatic;
+    if(isStatic == false)
+        dropFragment();
+}
+
+void Label::dropFragment()
+{
+    m_recordedEmpty = false;
+    m_recordFailed  = false;
+    if(m_fragment == nullptr)
+        return;
+    m_driver->ramG()->removeDisplayList(m_fragment);
+    m_fragment = nullptr;
+}
+
+void Label::setGeometry(int32_t  x,
+                        int32_t  y,
+                        uint16_t width,
+                        uint16_t height)
+{
+    m_autoWidth  = width == 0;
+    m_autoHeight = height == 0;
+    Widget::setGeometry(x, y, width, height);
+    dropFragment();
+    updateLayout();
+}
+
+void Label::setWidth(uint16_t width)
+{
+    m_autoWidth = width == 0;
+    Widget::setWidth(width);
+    dropFragment();
+    updateLayout();
+}
+
+void Label::setHeight(uint16_t height)
+{
+    m_autoHeight = height == 0;
+    Widget::setHeight(height);
+    dropFragment();
+    updateLayout();
+}
+
+void Label::updateLayout()
+{
+    if(m_font.customFont() != nullptr)
+        m_layout.setFont(m_font.customFont(), m_driver->ramG());
+    else
+        m_layout.setFont(m_font.fontMetrics());
+    m_layout.setText(m_text);
+    m_layout.setElide(m_elide);
+    //Layout works in font own size
+    if(m_fillWidth)
     {
-        m_height = m_font.fontHeight();
+        m_layout.setMaxWidth(m_font.unscaled(m_width));
+        m_layout.setMaxLines(m_elide && m_autoHeight == false
+                                 ? std::max<uint16_t>(m_height / m_font.fontHeight(), 1)
+                                 : 0);
     }
     else
     {
-        m_height = height;
+        m_layout.setMaxWidth(m_elide ? m_font.unscaled(m_width) : 0);
+        m_layout.setMaxLines(m_elide ? 1 : 0);
     }
+    uint16_t width  = m_width;
+    uint16_t height = m_height;
+    if(m_autoWidth && m_fillWidth == false)
+        m_width = m_font.scaled(m_layout.width());
+    if(m_autoHeight)
+        m_height = m_font.scaled(m_layout.height());
+    if(m_width != width || m_height != height)
+        updateBounds();
+}
+
+Label::Label(string   text,
+             int32_t  x,
+             int32_t  y,
+             uint16_t width,
+             uint16_t height,
+             Widget * parent) :
+    Widget(parent),
+    m_text(text)
+{
+    m_name       = "Label";
+    m_x          = x;
+    m_y          = y;
+    m_width      = width;
+    m_height     = height;
+    m_autoWidth  = width == 0;
+    m_autoHeight = height == 0;
+    updateLayout();
+    updateBounds();
 }
 
 Label::VAlignment Label::verticalAlignment() const
@@ -305,6 +438,7 @@ Label::VAlignment Label::verticalAlignment() const
 void Label::setVerticalAlignment(const VAlignment & verticalAlignment)
 {
     m_verticalAlignment = verticalAlignment;
+    dropFragment();
 }
 
 Label::HAlignment Label::horizontalAlignment() const
@@ -315,6 +449,7 @@ Label::HAlignment Label::horizontalAlignment() const
 void Label::setHorizontalAlignment(const HAlignment & horizontalAlignment)
 {
     m_horizontalAlignment = horizontalAlignment;
+    dropFragment();
 }
 
 bool Label::fillWidth() const
@@ -325,6 +460,25 @@ bool Label::fillWidth() const
 void Label::setFillWidth(bool fillWidth)
 {
     m_fillWidth = fillWidth;
+    dropFragment();
+    updateLayout();
+}
+
+bool Label::elide() const
+{
+    return m_elide;
+}
+
+void Label::setElide(bool elide)
+{
+    m_elide = elide;
+    dropFragment();
+    updateLayout();
+}
+
+const TextLayout & Label::layout() const
+{
+    return m_layout;
 }
 
 std::string Label::text() const
@@ -335,6 +489,8 @@ std::string Label::text() const
 void Label::setText(const std::string & label)
 {
     m_text = label;
+    dropFragment();
+    updateLayout();
 }
 
 Color Label::color() const
@@ -357,11 +513,105 @@ uint8_t LFont::fontNumber() const
     return m_fontNumber;
 }
 
+void LFont::setFont(uint8_t fontSize, LFont::FontType type)
+{
+    //Font number and pixel height of ROM fonts
+    static const uint8_t regular[][2]     = {{20, 13}, {21, 17}, {22, 20}, {23, 22}, {24, 29}, {25, 38}};
+    static const uint8_t antialiased[][2] = {{26, 16}, {27, 20}, {28, 25}, {29, 28}, {30, 36}, {31, 49}, {32, 63}, {33, 83}, {34, 108}};
+    static const uint8_t monospace[][2]   = {{16, 8}, {18, 16}};
+
+    const uint8_t(*fonts)[2];
+    size_t count;
+    switch(type)
+    {
+    case FTGUI::LFont::Regular:
+        fonts = regular;
+        count = sizeof(regular) / sizeof(regular[0]);
+        break;
+    case FTGUI::LFont::Monospace:
+        fonts = monospace;
+        count = sizeof(monospace) / sizeof(monospace[0]);
+        break;
+    default:
+        fonts = antialiased;
+        count = sizeof(antialiased) / sizeof(antialiased[0]);
+        break;
+    }
+    //Exact size or the biggest smaller font scaled up. Fonts 32...34 have no handle for scaling
+    m_fontNumber = fonts[0][0];
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(fonts[i][1] == fontSize)
+        {
+            m_fontNumber = fonts[i][0];
+            break;
+        }
+        if(fonts[i][1] < fontSize && fonts[i][0] < 32)
+            m_fontNumber = fonts[i][0];
+    }
+    m_fontType = type;
+    m_custom   = nullptr;
+    m_metrics  = metrics(m_driver, m_fontNumber);
+    setScale(fontSize);
+}
+
+void LFont::setFont(const Font * font, uint16_t size)
+{
+    m_custom     = font;
+    m_fontNumber = font->handle();
+    m_metrics    = nullptr;
+    debug_if(size != 0 && font->extended(), "Extended font is not scaled\n");
+    setScale(font->extended() ? 0 : size);
+}
+
+void LFont::setScale(uint16_t size)
+{
+    if(size == 0 || size == nativeHeight() || m_fontNumber > 31)
+    {
+        m_size       = 0;
+        m_transformA = bitmapTransformA(256);
+        m_transformE = bitmapTransformE(256);
+        return;
+    }
+    //Matrix maps screen to glyph pixels, so it is inverse of scale
+    m_size       = size;
+    int16_t a    = static_cast<int16_t>((256 * nativeHeight() + size / 2) / size);
+    m_transformA = bitmapTransformA(a);
+    m_transformE = bitmapTransformE(a);
+}
+
+const FontMetrics * LFont::metrics(FT8xx * driver, uint8_t font)
+{
+    //ROM fonts 16...34, filled on first use
+    static FontMetrics * cache[19]{};
+    if(font < 16 || font > 34)
+    {
+        debug("Font %u has no ROM metrics\n", font);
+        font = 16;
+    }
+    auto & entry = cache[font - 16];
+    if(entry == nullptr)
+    {
+        entry             = new FontMetrics;
+        uint32_t fPointer = driver->hal()->rd32(EVE_ROM_FONT_ADDR);
+        driver->hal()->rdByteBuffer(fPointer + (sizeof(FontMetrics) * (font - 16)),
+                                    reinterpret_cast<uint8_t *>(entry),
+                                    sizeof(FontMetrics));
+    }
+    return entry;
+}
+
 Scrim::Scrim(Widget * parent) :
     Rectangle(parent)
 {
     m_name     = "Scrim";
-    m_snapshot = m_driver->ramG()->saveSnapshot(m_name);
+    //Full size, scaled capture would block every modal opening with SPI read back
+    m_snapshot = m_driver->ramG()->saveSnapshot(m_name,
+                                                SnapshotBitmapFormat::ARGB4,
+                                                0,
+                                                0,
+                                                EVE_HSIZE,
+                                                EVE_VSIZE);
     setGeometry(0, 0, EVE_HSIZE, EVE_VSIZE);
     setColor(Main::Black);
     setOpacity(230);
@@ -395,7 +645,7 @@ void Scrim::show()
 
 void Scrim::takeSnapshot()
 {
-    m_driver->ramG()->updateSnapshot(m_snapshot);
+    m_snapshot = m_driver->ramG()->updateSnapshot(m_snapshot);
 }
 
 }    // namespace FTGUI
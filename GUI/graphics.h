@@ -25,6 +25,7 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include <textlayout.h>
 #include <widget.h>
 
 namespace FTGUI
@@ -108,106 +109,101 @@ public:
     LFont(FT8xx *  driver,
           uint8_t  fontSize,
           FontType type = Antialiased) :
-        //        m_fontTargetSize(fontSize),
         m_driver(driver)
     {
         setFont(fontSize, type);
     }
 
+    LFont(FT8xx * driver, const Font * font, uint16_t size = 0) :
+        m_driver(driver)
+    {
+        setFont(font, size);
+    }
+
+    /*!
+     * \brief charWidth - advance of character in font own size
+     */
     uint8_t charWidth(char c) const
     {
-        if(c <= 128)
-            return width.at(c);
+        auto code = static_cast<uint8_t>(c);
+        if(m_custom != nullptr)
+            return m_driver->ramG()->glyphWidth(m_custom, code);
+        if(code < 128)
+            return m_metrics->width[code];
         else
             return 0;
     }
+    /*!
+     * \brief fontHeight - height of drawn text (target size for scaled font)
+     */
     uint8_t fontHeight() const
     {
-        return pixelHeight;
+        return static_cast<uint8_t>(scaled(nativeHeight()));
     }
-
-    uint8_t fontNumber() const;
-    void    setFont(uint8_t         fontSize,
-                    LFont::FontType type = LFont::Antialiased)
+    uint16_t nativeHeight() const
     {
-        switch(type)
-        {
-        case FTGUI::LFont::Regular:
-            if(fontSize <= 13)
-                m_fontNumber = 20;
-            else if(fontSize > 13 && fontSize <= 17)
-                m_fontNumber = 21;
-            else if(fontSize > 17 && fontSize <= 20)
-                m_fontNumber = 22;
-            else if(fontSize > 20 && fontSize <= 22)
-                m_fontNumber = 23;
-            else if(fontSize > 22 && fontSize <= 29)
-                m_fontNumber = 24;
-            else
-                m_fontNumber = 25;
-            break;
-
-        case FTGUI::LFont::Antialiased:
-            if(fontSize <= 16)
-                m_fontNumber = 26;
-            else if(fontSize > 16 && fontSize <= 20)
-                m_fontNumber = 27;
-            else if(fontSize > 20 && fontSize <= 25)
-                m_fontNumber = 28;
-            else if(fontSize > 25 && fontSize <= 28)
-                m_fontNumber = 29;
-            else if(fontSize > 28 && fontSize <= 36)
-                m_fontNumber = 30;
-            else if(fontSize > 36 && fontSize <= 49)
-                m_fontNumber = 31;
-            else if(fontSize > 49 && fontSize <= 63)
-                m_fontNumber = 32;
-            else if(fontSize > 63 && fontSize <= 83)
-                m_fontNumber = 33;
-            else
-                m_fontNumber = 34;
-            break;
-
-        case FTGUI::LFont::Monospace:
-            if(fontSize <= 8)
-                m_fontNumber = 16;
-            else if(fontSize > 8)
-                m_fontNumber = 18;
-            break;
-        }
-
-        getFontParams();
+        if(m_custom != nullptr)
+            return m_custom->height();
+        return static_cast<uint16_t>(m_metrics->pixelHeight);
     }
-
-private:
-    //    uint16_t m_fontTargetSize{0};
-    FontType m_fontType{Antialiased};
-    uint8_t  m_fontNumber{16};
-    FT8xx *  m_driver{nullptr};
-    //Legacy fonts params
-    void getFontParams()
+    uint16_t nativeWidth() const
     {
-        uint32_t fPointer = m_driver->hal()->rd32(EVE_ROM_FONT_ADDR);
-        uint32_t fontIt   = fPointer + (148 * (m_fontNumber - 16));
-        uint16_t i        = 0;
-        while(i < 128)
-        {
-            width.push_back(m_driver->hal()->rd8(fontIt + i));
-            ++i;
-        }
-        format      = m_driver->hal()->rd32(fontIt + 128);
-        lineStride  = m_driver->hal()->rd32(fontIt + 132);
-        pixelWidth  = m_driver->hal()->rd8(fontIt + 136);
-        pixelHeight = m_driver->hal()->rd8(fontIt + 140);
-        gptr        = m_driver->hal()->rd32(fontIt + 144);
+        if(m_custom != nullptr)
+            return m_custom->width();
+        return static_cast<uint16_t>(m_metrics->pixelWidth);
     }
 
-    uint32_t             format{0};
-    uint32_t             lineStride{0};
-    uint32_t             gptr{0};
-    uint8_t              pixelWidth{0};
-    uint8_t              pixelHeight{0};
-    std::vector<uint8_t> width{};
+    /*!
+     * \brief metrics - metrics of ROM font shared by all fonts and labels.
+     * Metric block is read from EVE by one burst on first request and is kept for next ones
+     * \param font - font number 16...34
+     */
+    static const FontMetrics * metrics(FT8xx * driver, uint8_t font);
+
+    const FontMetrics * fontMetrics() const { return m_metrics; }
+    /*!
+     * \brief customFont - font loaded to Ram_G or nullptr for ROM font
+     */
+    const Font * customFont() const { return m_custom; }
+    /*!
+     * \brief setFont - use custom font. Font number is its handle
+     * \param size - target pixel height, 0 - font own size. Extended fonts are not scaled
+     */
+    void setFont(const Font * font, uint16_t size = 0);
+
+    uint8_t fontNumber() const;
+    /*!
+     * \brief setFont - select ROM font for pixel height. The biggest font not higher than fontSize is taken
+     * and scaled up to fontSize by bitmap transform if heights are different
+     */
+    void setFont(uint8_t         fontSize,
+                 LFont::FontType type = LFont::Antialiased);
+
+    /*!
+     * \brief isScaled - glyphs are drawn one by one with transform matrix, CMD_TEXT can't scale them
+     */
+    bool isScaled() const { return m_size != 0; }
+    //Convert size between font own and target sizes
+    uint16_t scaled(uint16_t v) const { return isScaled() ? v * m_size / nativeHeight() : v; }
+    uint16_t unscaled(uint16_t v) const { return isScaled() ? v * nativeHeight() / m_size : v; }
+    /*!
+     * \brief transformA - BITMAP_TRANSFORM_A and _E commands calculated for target size on font change
+     */
+    uint32_t transformA() const { return m_transformA; }
+    uint32_t transformE() const { return m_transformE; }
+
+private:
+    void setScale(uint16_t size);
+
+    FontType            m_fontType{Antialiased};
+    uint8_t             m_fontNumber{16};
+    FT8xx *             m_driver{nullptr};
+    const FontMetrics * m_metrics{nullptr};
+    const Font *        m_custom{nullptr};
+    //Target size of scaled font, 0 - not scaled
+    uint16_t m_size{0};
+    uint32_t m_transformA{bitmapTransformA(256)},
+        m_transformE{bitmapTransformE(256)};
 };
 
 //**************Label
@@ -230,8 +226,16 @@ public:
     Label(std::string text   = "",
           Widget *    parent = nullptr) :
         Label(text, 0, 0, 0, 0, parent) {}
+    virtual ~Label() override;
 
     void show() override;
+    void setGeometry(int32_t  x,
+                     int32_t  y,
+                     uint16_t width,
+                     uint16_t height) override;
+    //Size 0 - fit text
+    void setWidth(uint16_t width) override;
+    void setHeight(uint16_t height) override;
 
     Color color() const;
     void  setColor(const Color & color);
@@ -244,6 +248,26 @@ public:
     bool fillWidth() const;
     void setFillWidth(bool fillWidth);
 
+    /*!
+     * \brief setElide - cut text by label width with "..." at the end.
+     * Single line label is cut at first line, wrapped one (fillWidth) at the last line fitted to label height
+     */
+    bool elide() const;
+    void setElide(bool elide);
+
+    /*!
+     * \brief layout - lines of text measured with font metrics. Kept until text, font or size is changed
+     */
+    const TextLayout & layout() const;
+
+    /*!
+     * \brief setStatic - label text is not changed often. Glyphs produced by CMD_TEXT on first show are stored
+     * to Ram_G and next frames only append them with CMD_APPEND, moved by VERTEX_TRANSLATE.
+     * Stored glyphs are dropped when text, font, size or alignment is changed. Not used with paged fonts
+     */
+    bool isStatic() const;
+    void setStatic(bool isStatic);
+
     HAlignment horizontalAlignment() const;
     void       setHorizontalAlignment(const HAlignment & horizontalAlignment);
 
@@ -254,6 +278,18 @@ public:
                  LFont::FontType type = LFont::Antialiased)
     {
         m_font.setFont(size, type);
+        dropFragment();
+        updateLayout();
+    }
+    /*!
+     * \brief setFont - draw label with custom font. Text is UTF-8
+     * \param size - target pixel height, 0 - font own size
+     */
+    void setFont(const Font * font, uint16_t size = 0)
+    {
+        m_font.setFont(font, size);
+        dropFragment();
+        updateLayout();
     }
 
 private:
@@ -264,12 +300,31 @@ private:
           uint16_t    height = 0,
           Widget *    parent = nullptr);
 
+    //Set layout constraints and fit size to text when it isn't set by user
+    void updateLayout();
+    void dropFragment();
+    //Draw glyphs one by one with font transform
+    void drawScaled(int32_t y);
+
     bool        m_fillWidth{false};
+    bool        m_elide{false};
+    bool        m_autoWidth{false};
+    bool        m_autoHeight{false};
     VAlignment  m_verticalAlignment{Top};
     HAlignment  m_horizontalAlignment{Left};
     std::string m_text{};
     Color       m_color{m_theme->onPrimary()};
     LFont       m_font{m_driver, 20};
+    TextLayout  m_layout{};
+    //Static label
+    bool          m_static{false};
+    DisplayList * m_fragment{nullptr};
+    int32_t       m_fragmentX{0},
+        m_fragmentY{0};
+    //Recording produced nothing (f.e. empty text), so there is nothing to replay or record again
+    bool          m_recordedEmpty{false};
+    //No Ram_G for fragment, label is drawn by CMD_TEXT until it is changed
+    bool          m_recordFailed{false};
 };
 
 class Scrim : public Rectangle
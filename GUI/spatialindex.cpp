@@ -0,0 +1,125 @@
+/*!
+ * @file spatialindex.cpp
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "spatialindex.h"
+
+namespace FTGUI
+{
+SpatialIndex::SpatialIndex(uint16_t width, uint16_t height) :
+    m_columns((width + (1 << CellShift) - 1) >> CellShift),
+    m_rows((height + (1 << CellShift) - 1) >> CellShift),
+    m_cells(m_columns * m_rows)
+{
+}
+
+void SpatialIndex::insert(Widget * widget,
+                          int32_t  x,
+                          int32_t  y,
+                          uint16_t width,
+                          uint16_t height)
+{
+    uint16_t firstColumn, firstRow, lastColumn, lastRow;
+    if(cells(x, y, width, height, firstColumn, firstRow, lastColumn, lastRow) == false)
+        return;
+    for(uint16_t row = firstRow; row <= lastRow; ++row)
+    {
+        for(uint16_t column = firstColumn; column <= lastColumn; ++column)
+            m_cells[row * m_columns + column].push_back(widget);
+    }
+}
+
+void SpatialIndex::remove(Widget * widget,
+                          int32_t  x,
+                          int32_t  y,
+                          uint16_t width,
+                          uint16_t height)
+{
+    uint16_t firstColumn, firstRow, lastColumn, lastRow;
+    if(cells(x, y, width, height, firstColumn, firstRow, lastColumn, lastRow) == false)
+        return;
+    for(uint16_t row = firstRow; row <= lastRow; ++row)
+    {
+        for(uint16_t column = firstColumn; column <= lastColumn; ++column)
+        {
+            auto & cell = m_cells[row * m_columns + column];
+            cell.erase(std::remove(cell.begin(), cell.end(), widget), cell.end());
+        }
+    }
+}
+
+const std::vector<Widget *> & SpatialIndex::at(int32_t x, int32_t y) const
+{
+    if(x < 0 || y < 0)
+        return m_empty;
+    uint16_t column = x >> CellShift;
+    uint16_t row    = y >> CellShift;
+    if(column >= m_columns || row >= m_rows)
+        return m_empty;
+    return m_cells[row * m_columns + column];
+}
+
+void SpatialIndex::setFloating(Widget * widget, bool floating)
+{
+    m_floating.erase(std::remove(m_floating.begin(), m_floating.end(), widget), m_floating.end());
+    if(floating)
+        m_floating.push_back(widget);
+}
+
+const std::vector<Widget *> & SpatialIndex::floating() const
+{
+    return m_floating;
+}
+
+std::vector<Widget *> & SpatialIndex::candidates()
+{
+    return m_candidates;
+}
+
+bool SpatialIndex::cells(int32_t    x,
+                         int32_t    y,
+                         uint16_t   width,
+                         uint16_t   height,
+                         uint16_t & firstColumn,
+                         uint16_t & firstRow,
+                         uint16_t & lastColumn,
+                         uint16_t & lastRow) const
+{
+    int32_t right  = x + width - 1;
+    int32_t bottom = y + height - 1;
+    if(width == 0
+       || height == 0
+       || right < 0
+       || bottom < 0
+       || (x >> CellShift) >= m_columns
+       || (y >> CellShift) >= m_rows)
+    {
+        return false;
+    }
+    firstColumn = std::max<int32_t>(x, 0) >> CellShift;
+    firstRow    = std::max<int32_t>(y, 0) >> CellShift;
+    lastColumn  = std::min<int32_t>(right >> CellShift, m_columns - 1);
+    lastRow     = std::min<int32_t>(bottom >> CellShift, m_rows - 1);
+    return true;
+}
+}    // namespace FTGUI
@@ -0,0 +1,98 @@
+/*!
+ * @file spatialindex.h
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <algorithm>
+#include <ft8xx.h>
+#include <vector>
+
+namespace FTGUI
+{
+class Widget;
+
+/*!
+ * \brief SpatialIndex - uniform grid of absolute widget bounds over the screen.
+ * Each cell keeps widgets overlapping it, so widgets under a point are found without walking the tree.
+ * Widgets out of screen are not kept in cells
+ */
+class SpatialIndex
+{
+public:
+    SpatialIndex(uint16_t width  = EVE_HSIZE,
+                 uint16_t height = EVE_VSIZE);
+
+    void insert(Widget * widget,
+                int32_t  x,
+                int32_t  y,
+                uint16_t width,
+                uint16_t height);
+    void remove(Widget * widget,
+                int32_t  x,
+                int32_t  y,
+                uint16_t width,
+                uint16_t height);
+
+    /*!
+     * \brief at - widgets which bounds overlap cell with point. Bounds must be checked by caller
+     */
+    const std::vector<Widget *> & at(int32_t x, int32_t y) const;
+
+    /*!
+     * \brief setFloating - widget with animated position is not kept in cells, its parent checks it always
+     */
+    void                          setFloating(Widget * widget, bool floating);
+    const std::vector<Widget *> & floating() const;
+
+    /*!
+     * \brief candidates - stack of widgets found under touch point. Each tree level appends its children and
+     * cuts them off when done, so nested lookups reuse one buffer
+     */
+    std::vector<Widget *> & candidates();
+
+private:
+    //64 pixels cell
+    static constexpr uint8_t CellShift = 6;
+
+    uint16_t                           m_columns{0},
+        m_rows{0};
+    std::vector<std::vector<Widget *>> m_cells;
+    std::vector<Widget *>              m_floating;
+    std::vector<Widget *>              m_empty;
+    std::vector<Widget *>              m_candidates;
+
+    //Cell range of bounds clipped to grid, false if bounds are out of grid
+    bool cells(int32_t    x,
+               int32_t    y,
+               uint16_t   width,
+               uint16_t   height,
+               uint16_t & firstColumn,
+               uint16_t & firstRow,
+               uint16_t & lastColumn,
+               uint16_t & lastRow) const;
+};
+}    // namespace FTGUI
+
+#endif    // SPATIALINDEX_H
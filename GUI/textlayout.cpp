@@ -0,0 +1,243 @@
+/*!
+ * @file textlayout.cpp
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "textlayout.h"
+
+namespace FTGUI
+{
+uint16_t TextLayout::measure(const FontMetrics * metrics,
+                             const std::string & text,
+                             size_t              start,
+                             size_t              length)
+{
+    if(metrics == nullptr || start >= text.size())
+        return 0;
+    size_t   end   = length > text.size() - start ? text.size() : start + length;
+    uint16_t width = 0;
+    for(size_t i = start; i < end; ++i)
+    {
+        auto code = static_cast<uint8_t>(text[i]);
+        if(code < 128)
+            width += metrics->width[code];
+    }
+    return width;
+}
+
+void TextLayout::setFont(const FontMetrics * metrics)
+{
+    if(m_metrics == metrics && m_font == nullptr)
+        return;
+    m_metrics = metrics;
+    m_font    = nullptr;
+    m_dirty   = true;
+}
+
+void TextLayout::setFont(const EVE::Font * font, const EVE::RamG * ramG)
+{
+    if(m_font == font)
+        return;
+    m_metrics = nullptr;
+    m_font    = font;
+    m_ramG    = ramG;
+    m_dirty   = true;
+}
+
+void TextLayout::setText(const std::string & text)
+{
+    if(m_text == text)
+        return;
+    m_text  = text;
+    m_dirty = true;
+}
+
+void TextLayout::setMaxWidth(uint16_t maxWidth)
+{
+    if(m_maxWidth == maxWidth)
+        return;
+    m_maxWidth = maxWidth;
+    m_dirty    = true;
+}
+
+void TextLayout::setMaxLines(uint16_t maxLines)
+{
+    if(m_maxLines == maxLines)
+        return;
+    m_maxLines = maxLines;
+    m_dirty    = true;
+}
+
+void TextLayout::setElide(bool elide)
+{
+    if(m_elide == elide)
+        return;
+    m_elide = elide;
+    m_dirty = true;
+}
+
+const std::vector<TextLayout::Line> & TextLayout::lines() const
+{
+    layout();
+    return m_lines;
+}
+
+uint16_t TextLayout::width() const
+{
+    layout();
+    return m_width;
+}
+
+uint16_t TextLayout::height() const
+{
+    layout();
+    return static_cast<uint16_t>(m_lines.size() * lineHeight());
+}
+
+uint16_t TextLayout::lineHeight() const
+{
+    if(m_font != nullptr)
+        return m_font->height();
+    return m_metrics == nullptr ? 0 : static_cast<uint16_t>(m_metrics->pixelHeight);
+}
+
+uint16_t TextLayout::charWidth(uint32_t code) const
+{
+    if(m_font != nullptr)
+        return m_ramG->glyphWidth(m_font, code);
+    return code < 128 ? m_metrics->width[code] : 0;
+}
+
+uint32_t TextLayout::nextChar(const std::string & text, size_t & pos) const
+{
+    //ROM fonts are 7 bit, only custom fonts are UTF-8
+    if(m_font == nullptr)
+        return static_cast<uint8_t>(text[pos++]);
+    return EVE::Font::nextChar(text, pos);
+}
+
+uint16_t TextLayout::measureText(const std::string & text) const
+{
+    uint16_t width = 0;
+    for(size_t pos = 0; pos < text.size();)
+        width += charWidth(nextChar(text, pos));
+    return width;
+}
+
+void TextLayout::layout() const
+{
+    if(m_dirty == false)
+        return;
+    m_dirty = false;
+    m_cut   = false;
+    m_width = 0;
+    m_lines.clear();
+    if(m_metrics == nullptr && m_font == nullptr)
+        return;
+
+    size_t   lineStart = 0, lastSpace = std::string::npos;
+    uint16_t lineWidth = 0, spaceWidth = 0;
+    for(size_t i = 0, next = 0; i < m_text.size(); i = next)
+    {
+        if(m_maxLines != 0 && m_lines.size() == m_maxLines)
+        {
+            m_cut = true;
+            break;
+        }
+        uint32_t code = nextChar(m_text, next);
+        if(code == '\n')
+        {
+            addLine(lineStart, i);
+            lineStart = next;
+            lastSpace = std::string::npos;
+            lineWidth = 0;
+            continue;
+        }
+        uint16_t w = charWidth(code);
+        if(m_maxWidth != 0 && lineWidth + w > m_maxWidth && i > lineStart)
+        {
+            //Break after last space or inside too long word
+            if(lastSpace != std::string::npos)
+            {
+                addLine(lineStart, lastSpace);
+                lineStart = lastSpace + 1;
+                lineWidth = lineWidth - spaceWidth;
+            }
+            else
+            {
+                addLine(lineStart, i);
+                lineStart = i;
+                lineWidth = 0;
+            }
+            lastSpace = std::string::npos;
+        }
+        if(code == ' ')
+        {
+            lastSpace  = i;
+            spaceWidth = lineWidth + w;
+        }
+        lineWidth += w;
+    }
+    if(m_maxLines != 0 && m_lines.size() == m_maxLines)
+        m_cut = m_cut || lineStart < m_text.size();
+    else if(lineStart < m_text.size() || m_lines.empty())
+        addLine(lineStart, m_text.size());
+
+    if(m_elide && m_lines.empty() == false)
+    {
+        uint16_t limit = m_maxWidth;
+        if(m_cut || (limit != 0 && m_lines.back().width > limit))
+            elideLast(limit);
+    }
+    for(const auto & line : m_lines)
+        m_width = std::max(m_width, line.width);
+}
+
+void TextLayout::addLine(size_t start, size_t end) const
+{
+    //Spaces at line end are not visible
+    while(end > start && m_text[end - 1] == ' ')
+        --end;
+    auto text = m_text.substr(start, end - start);
+    m_lines.push_back({text, measureText(text)});
+}
+
+void TextLayout::elideLast(uint16_t maxWidth) const
+{
+    static const std::string ellipsis("...");
+    auto &                   line          = m_lines.back();
+    uint16_t                 ellipsisWidth = measureText(ellipsis);
+    if(maxWidth == 0)
+        maxWidth = line.width + ellipsisWidth;
+    while(line.text.empty() == false && line.width + ellipsisWidth > maxWidth)
+    {
+        //Drop whole UTF-8 character
+        size_t last = line.text.size() - 1;
+        while(last > 0 && (static_cast<uint8_t>(line.text[last]) & 0xC0) == 0x80)
+            --last;
+        line.text.erase(last);
+        line.width = measureText(line.text);
+    }
+    line.text += ellipsis;
+    line.width += ellipsisWidth;
+}
+}    // namespace FTGUI
@@ -0,0 +1,118 @@
+/*!
+ * @file textlayout.h
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <algorithm>
+#include <ft8xx.h>
+#include <string>
+#include <vector>
+
+namespace FTGUI
+{
+/*!
+ * \brief FontMetrics - legacy font metric block as it is stored in EVE memory (148 bytes)
+ */
+struct FontMetrics
+{
+    uint8_t  width[128];
+    uint32_t format;
+    uint32_t lineStride;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t gptr;
+};
+static_assert(sizeof(FontMetrics) == 148, "FontMetrics must match EVE metric block");
+
+/*!
+ * \brief TextLayout - host side text measurement and line breaking with font metrics.
+ * Lines are calculated once and kept until text, font or constraints are changed,
+ * so drawing doesn't need CMD_FILLWIDTH and widget size is known without CoPro.
+ * Text of custom fonts is UTF-8
+ */
+class TextLayout
+{
+public:
+    struct Line
+    {
+        std::string text;
+        uint16_t    width;
+    };
+
+    /*!
+     * \brief measure - width of string in pixels
+     */
+    static uint16_t measure(const FontMetrics * metrics,
+                            const std::string & text,
+                            size_t              start  = 0,
+                            size_t              length = std::string::npos);
+
+    void setFont(const FontMetrics * metrics);
+    /*!
+     * \brief setFont - custom font, widths are taken through Ram_G owned it
+     */
+    void setFont(const EVE::Font * font, const EVE::RamG * ramG);
+    void setText(const std::string & text);
+    /*!
+     * \param maxWidth - lines are wrapped by words to this width. 0 - no wrapping
+     */
+    void setMaxWidth(uint16_t maxWidth);
+    /*!
+     * \param maxLines - lines over this count are dropped. 0 - unlimited
+     */
+    void setMaxLines(uint16_t maxLines);
+    /*!
+     * \param elide - last line cut by width or line count ends with "..."
+     */
+    void setElide(bool elide);
+
+    const std::vector<Line> & lines() const;
+    uint16_t                  width() const;
+    uint16_t                  height() const;
+    uint16_t                  lineHeight() const;
+
+private:
+    void     layout() const;
+    void     addLine(size_t start, size_t end) const;
+    void     elideLast(uint16_t maxWidth) const;
+    uint16_t charWidth(uint32_t code) const;
+    uint16_t measureText(const std::string & text) const;
+    uint32_t nextChar(const std::string & text, size_t & pos) const;
+
+    const FontMetrics * m_metrics{nullptr};
+    const EVE::Font *   m_font{nullptr};
+    const EVE::RamG *   m_ramG{nullptr};
+    std::string         m_text{};
+    uint16_t            m_maxWidth{0};
+    uint16_t            m_maxLines{0};
+    bool                m_elide{false};
+
+    mutable bool              m_dirty{true};
+    mutable bool              m_cut{false};
+    mutable uint16_t          m_width{0};
+    mutable std::vector<Line> m_lines{};
+};
+}    // namespace FTGUI
+#endif    // TEXTLAYOUT_H
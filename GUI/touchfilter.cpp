@@ -0,0 +1,142 @@
+/*!
+ * @file touchfilter.cpp
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "touchfilter.h"
+
+namespace FTGUI
+{
+TouchFilter::TouchFilter(uint8_t window,
+                         uint8_t latency,
+                         Mode    mode) :
+    m_mode(mode)
+{
+    setWindow(window);
+    setLatency(latency);
+}
+
+uint8_t TouchFilter::window() const
+{
+    return m_window;
+}
+
+void TouchFilter::setWindow(uint8_t window)
+{
+    m_window = window == 0 ? 1 : (window > MaxWindow ? MaxWindow : window);
+    if(m_latency > m_window)
+        m_latency = m_window;
+    reset();
+}
+
+uint8_t TouchFilter::latency() const
+{
+    return m_latency;
+}
+
+void TouchFilter::setLatency(uint8_t latency)
+{
+    m_latency = latency == 0 ? 1 : (latency > m_window ? m_window : latency);
+}
+
+TouchFilter::Mode TouchFilter::mode() const
+{
+    return m_mode;
+}
+
+void TouchFilter::setMode(Mode mode)
+{
+    m_mode = mode;
+}
+
+void TouchFilter::reset()
+{
+    m_head    = 0;
+    m_count   = 0;
+    m_pending = 0;
+}
+
+bool TouchFilter::push(int16_t x, int16_t y)
+{
+    bool full = m_count == m_window;
+    m_x.push(x, m_head, m_count, full);
+    m_y.push(y, m_head, m_count, full);
+    if(full == false)
+        ++m_count;
+    m_head = m_head + 1 == m_window ? 0 : m_head + 1;
+    if(++m_pending < m_latency)
+        return false;
+    m_pending = 0;
+    return true;
+}
+
+int16_t TouchFilter::x() const
+{
+    return m_x.value(m_mode, m_count);
+}
+
+int16_t TouchFilter::y() const
+{
+    return m_y.value(m_mode, m_count);
+}
+
+void TouchFilter::Axis::push(int16_t value, uint8_t head, uint8_t count, bool full)
+{
+    uint8_t i;
+    if(full)
+    {
+        //New sample takes place of oldest one and moves to its order, only values between them are shifted
+        i = 0;
+        while(sorted[i] != ring[head])
+            ++i;
+        while(i + 1 < count && sorted[i + 1] < value)
+        {
+            sorted[i] = sorted[i + 1];
+            ++i;
+        }
+    }
+    else
+    {
+        i = count;
+    }
+    ring[head] = value;
+    while(i > 0 && sorted[i - 1] > value)
+    {
+        sorted[i] = sorted[i - 1];
+        --i;
+    }
+    sorted[i] = value;
+}
+
+int16_t TouchFilter::Axis::value(Mode mode, uint8_t count) const
+{
+    if(count == 0)
+        return 0;
+    if(mode == Median)
+        return sorted[count / 2];
+    uint8_t trim = count / 4;
+    int32_t sum  = 0;
+    for(uint8_t i = trim; i < count - trim; ++i)
+        sum += sorted[i];
+    return static_cast<int16_t>(sum / (count - 2 * trim));
+}
+}    // namespace FTGUI
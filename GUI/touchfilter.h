@@ -0,0 +1,90 @@
+/*!
+ * @file touchfilter.h
+ * is part of FTGUI Project
+ *
+ * @copyright (c) 2020 Mikhail Ivanov <masluf@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef TOUCHFILTER_H
+#define TOUCHFILTER_H
+
+#include <stdint.h>
+
+namespace FTGUI
+{
+/*!
+ * \brief TouchFilter - sliding window filter of touch coordinates.
+ * Samples are kept in fixed ring buffer and sorted copy, which is updated by insertion on every sample,
+ * so filter doesn't allocate memory and doesn't sort whole window
+ */
+class TouchFilter
+{
+public:
+    enum Mode
+    {
+        Median,
+        TrimmedMean    //Mean of middle half of window
+    };
+    static constexpr uint8_t MaxWindow = 16;
+
+    /*!
+     * \param window - count of last samples used for filtering, 1...MaxWindow
+     * \param latency - count of samples before first point is ready after touch down and between next points, 1...window
+     */
+    TouchFilter(uint8_t window  = 13,
+                uint8_t latency = 6,
+                Mode    mode    = Median);
+
+    uint8_t window() const;
+    void    setWindow(uint8_t window);
+    uint8_t latency() const;
+    void    setLatency(uint8_t latency);
+    Mode    mode() const;
+    void    setMode(Mode mode);
+
+    void reset();
+
+    /*!
+     * \brief push - add sample
+     * \return true if filtered point is ready
+     */
+    bool push(int16_t x, int16_t y);
+
+    int16_t x() const;
+    int16_t y() const;
+
+private:
+    struct Axis
+    {
+        int16_t ring[MaxWindow];
+        int16_t sorted[MaxWindow];
+
+        void    push(int16_t value, uint8_t head, uint8_t count, bool full);
+        int16_t value(Mode mode, uint8_t count) const;
+    };
+
+    Axis    m_x, m_y;
+    uint8_t m_window{1}, m_latency{1};
+    Mode    m_mode;
+    uint8_t m_head{0}, m_count{0}, m_pending{0};
+};
+}    // namespace FTGUI
+
+#endif    // TOUCHFILTER_H
@@ -68,6 +68,7 @@ void Widget::addWidget(Widget * widget)
     if(widget == this)
         return;
     m_container.push_back(widget);
+    widget->updateBounds();
 }
 
 void Widget::removeWidget(Widget * widget)
@@ -81,16 +82,27 @@ void Widget::removeWidget(Widget * widget)
 
 Widget::~Widget()
 {
+    if(m_tag != 0)
+        unregisterTag(this);
+    if(m_indexed)
+        m_index->remove(this, m_boundsX, m_boundsY, m_boundsWidth, m_boundsHeight);
+    if(m_floating && m_index)
+        m_index->setFloating(this, false);
     //    if(m_onPressed)
     delete m_onPressed;
     //    if(m_onChanged)
     delete m_onChanged;
     //    if(m_onReleased)
     delete m_onReleased;
+    delete m_onTouchPoint;
+    delete m_onGesture;
     for(auto w : m_container)
     {
         delete w;
     }
+    //Index is owned by root widget
+    if(m_parent == this)
+        delete m_index;
 }
 
 void Widget::show()
@@ -106,7 +118,7 @@ void Widget::show()
     for(const auto & w : m_container)
     {
         if(w->visible() != false)
-            w->show();
+            showChild(w);
     }
     //    debug("%s : %i, %i, %u, %u \n", m_name.c_str(), m_x, m_y, m_width, m_height);
     m_visible = true;
@@ -126,6 +138,68 @@ void Widget::update()
     m_parent->update();
 }
 
+bool Widget::interactive() const
+{
+    return m_onPressed || m_onChanged || m_onReleased;
+}
+
+void Widget::registerTag(Widget * widget)
+{
+    if(m_parent != this && m_parent)
+        m_parent->registerTag(widget);
+}
+
+void Widget::unregisterTag(Widget * widget)
+{
+    if(m_parent != this && m_parent)
+        m_parent->unregisterTag(widget);
+}
+
+void Widget::showChild(Widget * widget)
+{
+    //Tag is kept only while widget is interactive and on screen
+    if(widget->m_tagHitTest && widget->interactive() && widget->checkPositionInScreen())
+    {
+        if(widget->m_tag == 0)
+            registerTag(widget);
+        widget->m_tagFrame = m_driver->frame();
+    }
+    else if(widget->m_tag != 0)
+    {
+        unregisterTag(widget);
+    }
+    //Children without own tag are hit as part of this widget
+    uint8_t drawTag = widget->m_tag != 0 ? widget->m_tag : m_drawTag;
+    widget->m_drawTag = drawTag;
+    if(drawTag != m_drawTag)
+        m_driver->tag(drawTag);
+    //Widget may be deleted by show
+    widget->show();
+    if(drawTag != m_drawTag)
+        m_driver->tag(m_drawTag);
+}
+
+void Widget::setTagHitTest(bool enable)
+{
+    m_tagHitTest = enable;
+    if(enable == false && m_tag != 0)
+        unregisterTag(this);
+    for(const auto & w : m_container)
+    {
+        w->setTagHitTest(enable);
+    }
+}
+
+bool Widget::tagHitTest() const
+{
+    return m_tagHitTest;
+}
+
+uint8_t Widget::tag() const
+{
+    return m_tag;
+}
+
 void Widget::animationStarted(void *   value,
                               uint32_t duration,
                               uint8_t  delay)
@@ -156,6 +230,7 @@ void Widget::setGeometry(int32_t  x,
     m_y      = y;
     m_width  = width;
     m_height = height;
+    updateBounds();
 }
 
 const string & Widget::name() const
@@ -180,6 +255,9 @@ void Widget::setParent(Widget * parent)
     m_orientation = m_parent->orientation();
     m_theme       = m_parent->theme();
     m_queue       = m_parent->queue();
+    m_tagHitTest  = m_parent->tagHitTest();
+    m_index       = m_parent != this ? m_parent->m_index : m_index;
+    invalidatePosition();
 }
 
 FT8xx * Widget::driver() const
@@ -199,6 +277,13 @@ void Widget::setTheme(Theme * theme)
 
 bool Widget::checkPositionInScreen()
 {
+    if(m_indexed)
+    {
+        return m_boundsX <= EVE_HSIZE
+               && m_boundsY <= EVE_VSIZE
+               && m_boundsX + m_boundsWidth >= 0
+               && m_boundsY + m_boundsHeight >= 0;
+    }
     //Check is widget is in screen
     if(absX() > EVE_HSIZE
        || absY() > EVE_VSIZE
@@ -210,6 +295,124 @@ bool Widget::checkPositionInScreen()
     return true;
 }
 
+void Widget::updateBounds()
+{
+    invalidatePosition();
+    if(m_index == nullptr || m_parent == nullptr || m_parent == this)
+        return;
+    updateBounds(m_parent->absX(), m_parent->absY());
+}
+
+void Widget::updateBounds(int32_t parentX, int32_t parentY)
+{
+    if(m_floating)
+        return;
+    if(m_indexed)
+        m_index->remove(this, m_boundsX, m_boundsY, m_boundsWidth, m_boundsHeight);
+    m_boundsX      = parentX + m_x;
+    m_boundsY      = parentY + m_y;
+    m_boundsWidth  = m_width;
+    m_boundsHeight = m_height;
+    m_absX          = m_boundsX;
+    m_absY          = m_boundsY;
+    m_absValid      = true;
+    m_index->insert(this, m_boundsX, m_boundsY, m_boundsWidth, m_boundsHeight);
+    m_indexed = true;
+    for(const auto & w : m_container)
+    {
+        w->updateBounds(m_boundsX, m_boundsY);
+    }
+}
+
+void Widget::positionLanded()
+{
+    if(--m_moving == 0)
+        setFloating(false);
+}
+
+void Widget::setFloating(bool floating)
+{
+    if(m_index == nullptr)
+        return;
+    bool parentFloating = m_parent != nullptr && m_parent != this && m_parent->m_floating;
+    //Subtree of floating parent is indexed when parent lands
+    if(floating == false && parentFloating)
+        return;
+    //Only top of floating subtree is listed, its children are found through it
+    m_index->setFloating(this, floating && parentFloating == false);
+    dropBounds(floating);
+    if(floating == false)
+        updateBounds();
+}
+
+void Widget::dropBounds(bool floating)
+{
+    if(m_indexed)
+        m_index->remove(this, m_boundsX, m_boundsY, m_boundsWidth, m_boundsHeight);
+    m_indexed  = false;
+    m_floating = floating;
+    for(const auto & w : m_container)
+    {
+        //Child still moving stays floating as top of its own subtree
+        if(floating == false && w->m_moving != 0)
+        {
+            m_index->setFloating(w, true);
+            continue;
+        }
+        m_index->setFloating(w, false);
+        w->dropBounds(floating);
+    }
+}
+
+template<typename F>
+bool Widget::forChildrenAt(int16_t x, int16_t y, F && f) const
+{
+    if(m_index == nullptr)
+    {
+        for(size_t i = 0; i < m_container.size(); ++i)
+        {
+            if(f(m_container[i]))
+                return true;
+        }
+        return false;
+    }
+    //Handlers may move widgets and change index cells, so children are taken to candidates before
+    auto & candidates = m_index->candidates();
+    size_t first      = candidates.size();
+    if(m_floating)
+    {
+        candidates.insert(candidates.end(), m_container.begin(), m_container.end());
+    }
+    else
+    {
+        for(const auto & w : m_index->at(x, y))
+        {
+            //Modal widgets are children of root too, but they are not in container
+            if(w->m_parent == this
+               && w->m_modal == false
+               && x > w->m_boundsX
+               && x < w->m_boundsX + w->m_boundsWidth
+               && y > w->m_boundsY
+               && y < w->m_boundsY + w->m_boundsHeight)
+            {
+                candidates.push_back(w);
+            }
+        }
+        for(const auto & w : m_index->floating())
+        {
+            if(w->m_parent == this && w->m_modal == false)
+                candidates.push_back(w);
+        }
+    }
+    //Nested lookups go after last and are cut off before returning here
+    size_t last    = candidates.size();
+    bool   handled = false;
+    for(size_t i = first; i < last && handled == false; ++i)
+        handled = f(candidates[i]);
+    candidates.resize(first);
+    return handled;
+}
+
 void Widget::animation(int32_t *       value,
                        int32_t         from,
                        int32_t         to,
@@ -227,13 +430,30 @@ void Widget::animation(int32_t *       value,
         return;
     }
     m_animationBlock.push_back(value);
+    //Every step of position moves children too
+    mbed::Callback<void()> step = nullptr;
+    mbed::Callback<void()> done = nullptr;
+    //Bounds are not known while position is animated
+    if(value == &m_x || value == &m_y)
+    {
+        if(m_moving++ == 0)
+            setFloating(true);
+        step = mbed::callback(this, &Widget::positionStepped);
+        //Final value is written by driver thread, index is updated by GUI thread after it
+        done = [this]() {
+            debug_if(queue()->call(this, &Widget::positionLanded) == 0,
+                     "GUI queue is full, widget stays floating\n");
+        };
+    }
     m_driver->animate(
         value,
         from,
         to,
         duration,
         fadeType,
-        delay);
+        delay,
+        step,
+        done);
     animationStarted(value, duration, delay);
 }
 
@@ -259,22 +479,66 @@ EventQueue * Widget::queue() const
 
 int32_t Widget::absX() const
 {
-    int32_t x = m_x;
+    if(positionCached() == false)
+        updatePosition();
+    return m_absX;
+}
+
+int32_t Widget::absY() const
+{
+    if(positionCached() == false)
+        updatePosition();
+    return m_absY;
+}
+
+void Widget::updatePosition() const
+{
+    //Step coming while position is calculated makes cache old again
+    m_absGeneration = m_floating ? animationSteps() : 0;
+    m_absX          = m_x;
+    m_absY          = m_y;
     if(m_parent != this && m_parent)
     {
-        x += m_parent->absX();
+        m_absX += m_parent->absX();
+        m_absY += m_parent->absY();
     }
-    return x;
+    m_absValid = true;
 }
 
-int32_t Widget::absY() const
+bool Widget::positionCached() const
 {
-    int32_t y = m_y;
-    if(m_parent != this && m_parent)
+    //Only floating subtree is moved by driver thread, other widgets keep cache till invalidatePosition
+    return m_absValid && (m_floating == false || m_absGeneration == animationSteps());
+}
+
+void Widget::positionStepped()
+{
+    ++m_positionSteps;
+}
+
+uint32_t Widget::animationSteps() const
+{
+    //All children of moving widget are floating, so its floating chain reaches every moving ancestor
+    uint32_t steps = 0;
+    for(auto w = this; w->m_floating; w = w->m_parent)
     {
-        y += m_parent->absY();
+        steps += w->m_positionSteps.load();
+        if(w->m_parent == w || w->m_parent == nullptr)
+            break;
+    }
+    return steps;
+}
+
+void Widget::invalidatePosition()
+{
+    //Children of invalid widget are invalid already
+    if(m_absValid == false)
+        return;
+    m_absValid = false;
+    for(const auto & w : m_container)
+    {
+        w->invalidatePosition();
     }
-    return y;
 }
 
 bool Widget::visible() const
@@ -302,6 +566,7 @@ bool Widget::toggleVisible()
 void Widget::setHeight(uint16_t height)
 {
     m_height = height;
+    updateBounds();
 }
 
 bool Widget::touchPressed(int16_t x,
@@ -316,10 +581,10 @@ bool Widget::touchPressed(int16_t x,
     {
         if(m_onPressed)
             m_onPressed->operator()(x, y);
-        for(const auto & w : m_container)
-        {
+        forChildrenAt(x, y, [&](Widget * w) {
             w->touchPressed(x, y);
-        }
+            return false;
+        });
         //        debug("%s pressed %i:%i\n", m_name.c_str(), x, y);
         return true;
     }
@@ -340,10 +605,10 @@ bool Widget::touchChanged(int16_t         x,
     {
         if(m_onChanged)
             m_onChanged->operator()(x, y);
-        for(const auto & w : m_container)
-        {
+        forChildrenAt(x, y, [&](Widget * w) {
             w->touchChanged(x, y, accelerationX, accelerationY);
-        }
+            return false;
+        });
         //            debug("%s changed %i:%i\n", m_name.c_str(), x, y);
         return true;
     }
@@ -364,29 +629,76 @@ bool Widget::touchReleased(int16_t x,
     {
         if(m_onReleased)
             m_onReleased->operator()(x, y);
-        for(const auto & w : m_container)
-        {
+        forChildrenAt(x, y, [&](Widget * w) {
             w->touchReleased(x, y, accelerationX, accelerationY);
-        }
+            return false;
+        });
         //            debug("%s released %i:%i\n", m_name.c_str(), x, y);
         return true;
     }
     return false;
 }
 
+bool Widget::touchPoint(uint8_t    finger,
+                        TouchPhase phase,
+                        int16_t    x,
+                        int16_t    y)
+{
+    if(m_visible == false)
+        return false;
+    //Released finger is routed to widgets under its last point
+    if(x > absX()
+       && x < absX() + m_width
+       && y > absY()
+       && y < absY() + m_height)
+    {
+        if(m_onTouchPoint)
+            m_onTouchPoint->operator()(finger, phase, x, y);
+        forChildrenAt(x, y, [&](Widget * w) {
+            w->touchPoint(finger, phase, x, y);
+            return false;
+        });
+        return true;
+    }
+    return false;
+}
+
+bool Widget::gesture(const Gesture & gesture)
+{
+    if(m_visible == false)
+        return false;
+    if(gesture.x > absX()
+       && gesture.x < absX() + m_width
+       && gesture.y > absY()
+       && gesture.y < absY() + m_height)
+    {
+        if(forChildrenAt(gesture.x, gesture.y, [&](Widget * w) { return w->gesture(gesture); }))
+            return true;
+        if(m_onGesture)
+        {
+            m_onGesture->operator()(gesture);
+            return true;
+        }
+    }
+    return false;
+}
+
 void Widget::setWidth(uint16_t width)
 {
     m_width = width;
+    updateBounds();
 }
 
 void Widget::setY(int32_t y)
 {
     m_y = y;
+    updateBounds();
 }
 
 void Widget::setX(int32_t x)
 {
     m_x = x;
+    updateBounds();
 }
 
 void Widget::setZ(uint16_t z)
@@ -27,6 +27,9 @@
 
 #include <colors.h>
 #include <ft8xx.h>
+#include <gesture.h>
+#include <atomic>
+#include <spatialindex.h>
 #include <type_traits>
 
 namespace FTGUI
@@ -38,6 +41,7 @@ class Widget
     friend class List;
     friend class Page;
     friend class Dialog;
+    friend class ApplicationWindow;
 
 public:
     Widget(Widget * parent, bool modal = false);
@@ -112,6 +116,48 @@ public:
                                int16_t accelerationX,
                                int16_t accelerationY);
 
+    /*!
+     * \brief touchPoint - event of one finger in multi-touch mode, finger 0 is primary touch
+     */
+    virtual bool touchPoint(uint8_t    finger,
+                            TouchPhase phase,
+                            int16_t    x,
+                            int16_t    y);
+    /*!
+     * \brief gesture - recognized gesture. Innermost widget under gesture point with handler takes it
+     * \return true if gesture is handled
+     */
+    virtual bool gesture(const Gesture & gesture);
+
+    template<typename... Args>
+    void onTouchPoint(Args &&... args)
+    {
+        if(m_onTouchPoint)
+            delete m_onTouchPoint;
+        m_onTouchPoint = wrapCB<uint8_t, TouchPhase, int16_t, int16_t>(args...);
+    }
+
+    template<typename... Args>
+    void onGesture(Args &&... args)
+    {
+        if(m_onGesture)
+            delete m_onGesture;
+        m_onGesture = wrapCB<const Gesture &>(args...);
+    }
+
+    /*!
+     * \brief setTagHitTest - give EVE tags to interactive widgets while they are shown on screen.
+     * Touch is dispatched by REG_TOUCH_TAG instead of geometric search through whole tree.
+     * Up to 128 widgets are tagged at once, widget without tag is hit as part of its parent
+     */
+    void setTagHitTest(bool enable);
+    bool tagHitTest() const;
+
+    /*!
+     * \brief tag - EVE tag of widget, 0 - widget has no tag
+     */
+    uint8_t tag() const;
+
     template<typename... Args>
     void onPressed(Args &&... args)
     {
@@ -167,12 +213,39 @@ protected:
         Delay    = 20
     };
     virtual void update();
+    //Widget with touch handlers. It gets own tag in tag hit test mode
+    virtual bool interactive() const;
+    //Give tag to widget and release it. Handled by root widget
+    virtual void registerTag(Widget * widget);
+    virtual void unregisterTag(Widget * widget);
+    //Show child with its tag and restore tag of this widget after
+    void showChild(Widget * widget);
     virtual void animationStarted(void *   value,
                                   uint32_t duration = AnimationOpt::Duration,
                                   uint8_t  delay    = AnimationOpt::Delay);
 
     bool checkPositionInScreen();
 
+    //Drop cached absolute position of widget and its children
+    void invalidatePosition();
+    void updatePosition() const;
+    bool positionCached() const;
+    //Animation step of widget position. Called from driver thread, so it only counts steps
+    void positionStepped();
+    //Steps of floating widget and its floating ancestors, cache of unchanged sum is valid
+    uint32_t animationSteps() const;
+    //Refresh absolute position and bounds in spatial index of widget and its children
+    void updateBounds();
+    void updateBounds(int32_t parentX, int32_t parentY);
+    //Animated widget and its children are checked without index
+    void setFloating(bool floating);
+    //Position animation is finished
+    void positionLanded();
+    void dropBounds(bool floating);
+    //Call f for children which may contain point, all children without index. Stops when f returns true
+    template<typename F>
+    bool forChildrenAt(int16_t x, int16_t y, F && f) const;
+
     virtual void animation(int32_t *       value,
                            int32_t         from,
                            int32_t         to,
@@ -186,6 +259,22 @@ protected:
     EventQueue * m_queue{nullptr};
     bool         m_modal{false};
     bool         m_toDelete{false};
+    bool         m_tagHitTest{false};
+    uint8_t      m_tag{0};
+    //Frame widget was last drawn with its tag
+    uint32_t m_tagFrame{0};
+    //Tag pushed to display list while widget is drawn, own or inherited from parent
+    uint8_t m_drawTag{0};
+
+    //Spatial index of root widget, bounds are valid if m_indexed
+    SpatialIndex * m_index{nullptr};
+    bool           m_indexed{false},
+        m_floating{false};
+    uint8_t  m_moving{0};
+    int32_t  m_boundsX{0},
+        m_boundsY{0};
+    uint16_t m_boundsWidth{0},
+        m_boundsHeight{0};
 
     std::vector<void *> m_animationBlock;
 
@@ -196,10 +285,20 @@ protected:
     std::function<void(uint16_t, uint16_t)> * m_onChanged{nullptr};
     std::function<void(uint16_t, uint16_t)> * m_onReleased{nullptr};
 
+    std::function<void(uint8_t, TouchPhase, int16_t, int16_t)> * m_onTouchPoint{nullptr};
+    std::function<void(const Gesture &)> *                       m_onGesture{nullptr};
+
     string m_name{"Widget"};
 
     int32_t m_x{0},
         m_y{0};
+    //Absolute position, valid cache means parent one is valid too
+    mutable int32_t m_absX{0},
+        m_absY{0};
+    mutable bool m_absValid{false};
+    //Cache of floating widget taken before later animation steps is recalculated by GUI thread
+    mutable uint32_t      m_absGeneration{0};
+    std::atomic<uint32_t> m_positionSteps{0};
     uint16_t m_z{0},
         m_width{0},
         m_height{0};
@@ -485,12 +485,58 @@ int32_t FT8xx::touchXY()
     return static_cast<int32_t>(m_hal->rd32(REG_TOUCH_SCREEN_XY));
 }
 
-void FT8xx::animate(int32_t * value,
-                    int32_t   from,
-                    int32_t   to,
-                    uint32_t  duration,
-                    FadeType  fadeType,
-                    uint8_t   delay)
+uint8_t FT8xx::touchTag()
+{
+    return m_hal->rd8(REG_TOUCH_TAG);
+}
+
+#if defined(FT81X_ENABLE)
+void FT8xx::setExtendedTouch(bool enable)
+{
+    m_hal->wr8(REG_CTOUCH_EXTENDED, enable ? 0 : 1);
+}
+
+uint8_t FT8xx::touchPoints(int16_t x[MaxTouchPoints], int16_t y[MaxTouchPoints])
+{
+    //Touch registers are scattered from REG_CTOUCH_TOUCH1_XY to REG_CTOUCH_TOUCH3_XY
+    static constexpr uint32_t First = REG_CTOUCH_TOUCH1_XY;
+    uint8_t                   regs[REG_CTOUCH_TOUCH3_XY + 4 - First];
+    m_hal->rdByteBuffer(First, regs, sizeof(regs));
+    auto half = [&](uint32_t address, uint8_t part) -> int16_t {
+        uint32_t offset = address - First + part * 2;
+        return static_cast<int16_t>(regs[offset] | (regs[offset + 1] << 8));
+    };
+    //XY registers keep X in high half word
+    static constexpr uint32_t XY[MaxTouchPoints - 1] = {REG_CTOUCH_TOUCH0_XY,
+                                                        REG_CTOUCH_TOUCH1_XY,
+                                                        REG_CTOUCH_TOUCH2_XY,
+                                                        REG_CTOUCH_TOUCH3_XY};
+    for(uint8_t i = 0; i < MaxTouchPoints - 1; ++i)
+    {
+        x[i] = half(XY[i], 1);
+        y[i] = half(XY[i], 0);
+    }
+    x[4] = half(REG_CTOUCH_TOUCH4_X, 0);
+    y[4] = half(REG_CTOUCH_TOUCH4_Y, 0);
+
+    uint8_t mask = 0;
+    for(uint8_t i = 0; i < MaxTouchPoints; ++i)
+    {
+        if(x[i] != -32768)
+            mask |= 1 << i;
+    }
+    return mask;
+}
+#endif
+
+void FT8xx::animate(int32_t *              value,
+                    int32_t                from,
+                    int32_t                to,
+                    uint32_t               duration,
+                    FadeType               fadeType,
+                    uint8_t                delay,
+                    mbed::Callback<void()> step,
+                    mbed::Callback<void()> done)
 {
     debug_if(duration % delay != 0, "duration %% delay must be equal 0\n");
     auto fade = new Fade{
@@ -500,6 +546,8 @@ void FT8xx::animate(int32_t * value,
         from,
         delay,
         fadeType,
+        step,
+        done,
     };
 
     m_queue->call_in(delay, this, &FT8xx::p_animate, value, fade);
@@ -511,17 +559,25 @@ const RamG * FT8xx::ramG()
     return m_ramG;
 }
 
-uint8_t FT8xx::flashInit(uint32_t size)
+uint8_t FT8xx::flashInit(uint32_t size, uint32_t directory)
 {
     m_flash = new Flash(this, size);
     if(m_flash->flashStatus() == FlashStatus::FLASH_STATUS_DETACHED || m_flash->flashStatus() == FlashStatus::FLASH_STATUS_INIT)
     {
         delete m_flash;
+        m_flash = nullptr;
         return -1;
     }
+    //Asset directory is optional
+    m_flash->loadDirectory(directory);
     return 0;
 }
 
+const Flash * FT8xx::flash()
+{
+    return m_flash;
+}
+
 void FT8xx::rebootCoPro()
 {
     debug("CoPro error. Reboot started!\n");
@@ -581,23 +637,12 @@ void FT8xx::rebootCoPro()
     debug("EVE Reboot compleated!\n");
 }
 
-void FT8xx::writeString(const string & text)
+void FT8xx::writeString(const char * text, size_t length)
 {
-    for(auto it = text.cbegin(); it != text.cend();)
-    {
-        CmdBuf_t value;
-        for(uint8_t i = 0; i < 4; ++i)
-        {
-            value.byte[i] = static_cast<int8_t>(*it);
-            ++it;
-            if(it == text.cend())
-                break;
-        }
-        push(value);
-    }
-    //append 4 zero byte if text aligned to 4 byte
-    if(text.size() % 4 == 0)
-        push(0x0);
+    auto         pushWord = [this](uint32_t word) { push(word); };
+    StringPacker packer;
+    packer.add(text, length, pushWord);
+    packer.finish(pushWord);
 }
 
 void FT8xx::push(const CmdBuf_t & command)
@@ -613,13 +658,19 @@ void FT8xx::push(const CmdBuf_t & command)
     }
 }
 
-void FT8xx::execute()
+void FT8xx::resetBitmapHandles()
+{
+    for(auto & h : m_bitmapHandles)
+        h.lastUse = 0;
+}
+
+bool FT8xx::execute(uint32_t timeout)
 {
     //if Nothing to execute
     if(m_cmdBuffer.size() == 0)
     {
         debug("if Nothing to execute\n");
-        return;
+        return true;
     }
     //if RamDL will be overflow
     if(m_ramDLobserver > EVE_RAM_DL_SIZE)
@@ -630,13 +681,13 @@ void FT8xx::execute()
         m_ramDLobserver = 0;
         //clear cmdBuffer lock flag
         m_eventFlags.set(CmdBufBusy);
-        return;
+        return false;
     }
     //If cmdBuffer will be overflow
     if(m_cmdBuffer.size() > EVE_CMDFIFO_SIZE)
     {
         debug("cmdBuffer overflow\n");
-        return;
+        return false;
     }
     //Blocking any operation with CmdBuffer while it is not sended to EVE FIFO
     m_eventFlags.clear(EVEeventFlags::CmdBufBusy);
@@ -662,7 +713,7 @@ void FT8xx::execute()
     {
         rebootCoPro();
         m_eventFlags.set(EVEeventFlags::CoProBusy);
-        return;
+        return false;
     }
     //Clear cmdBuffer
     m_cmdBuffer.clear();
@@ -670,20 +721,143 @@ void FT8xx::execute()
     //clear cmdBuffer lock flag
     m_eventFlags.set(CmdBufBusy);
     //Wait while CoPro working
-    for(uint32_t i = 0; i < 100; ++i)
+    bool idle = waitCoProIdle(timeout);
+    m_eventFlags.set(EVEeventFlags::CoProBusy);
+    return idle;
+}
+
+bool FT8xx::writeData(const uint8_t * data, uint32_t size)
+{
+    //Blocking any operation with CmdBuffer while it is not sended to EVE FIFO
+    m_eventFlags.clear(EVEeventFlags::CmdBufBusy);
+    //If CoPro busy now - wait
+    m_eventFlags.wait_any(EVEeventFlags::CoProBusy);
+
+    //Command header (f.e. CMD_LOADIMAGE, ptr, options) goes first in one burst
+    sendCmdBuffer();
+
+    //Payload must be 4 byte aligned, pad tail with zeros
+    uint32_t padded = (size + 3) & ~3UL;
+    uint32_t sent   = 0;
+    while(sent < padded)
     {
-        if(m_hal->rd16(REG_CMDB_SPACE) == 4092)
-            break;
-        ThisThread::sleep_for(10);
-        if(i == 99)
+        //Write as much as CoPro FIFO can take in one SPI transaction
+        uint32_t space = m_hal->rd16(REG_CMDB_SPACE) & 0xFFC;
+        if(space == 0)
         {
-            rebootCoPro();
-            m_eventFlags.set(EVEeventFlags::CoProBusy);
-            return;
+            if(m_hal->rd16(REG_CMD_READ) == 0xFFF)
+                break;
+            ThisThread::sleep_for(1);
+            continue;
+        }
+        uint32_t chunk = std::min(space, padded - sent);
+        m_hal->csSet();
+        m_hal->write(static_cast<uint8_t>((REG_CMDB_WRITE) >> 16) | MEM_WRITE);
+        m_hal->write(static_cast<uint8_t>((REG_CMDB_WRITE) >> 8));
+        m_hal->write(static_cast<uint8_t>(REG_CMDB_WRITE));
+        for(uint32_t i = sent; i < sent + chunk; ++i)
+        {
+            m_hal->write(i < size ? data[i] : 0);
         }
+        m_hal->csClear();
+        sent += chunk;
+    }
+
+    //If CoPro commands fault reboot it
+    if(m_hal->rd16(REG_CMD_READ) == 0xFFF)
+    {
+        rebootCoPro();
+        m_eventFlags.set(CmdBufBusy);
+        m_eventFlags.set(EVEeventFlags::CoProBusy);
+        return false;
+    }
+    m_eventFlags.set(CmdBufBusy);
+    bool idle = waitCoProIdle();
+    m_eventFlags.set(EVEeventFlags::CoProBusy);
+    return idle;
+}
+
+bool FT8xx::writeStream(MediaFifo * fifo, DataProducer producer)
+{
+    //Blocking any operation with CmdBuffer while it is not sended to EVE FIFO
+    m_eventFlags.clear(EVEeventFlags::CmdBufBusy);
+    //If CoPro busy now - wait
+    m_eventFlags.wait_any(EVEeventFlags::CoProBusy);
+
+    //CoPro starts command and waits data in MediaFIFO
+    sendCmdBuffer();
+
+    //Only last chunk may be not 4 byte aligned, keep tail for next chunk
+    uint8_t  chunk[MediaFifo::ChunkSize + 4];
+    uint32_t carry = 0;
+    bool     ok    = true;
+    while(ok)
+    {
+        uint32_t len = producer(chunk + carry, MediaFifo::ChunkSize);
+        if(len == 0)
+            break;
+        len += carry;
+        uint32_t aligned = len & ~3UL;
+        ok               = fifo->writeAll(chunk, aligned);
+        carry            = len - aligned;
+        memmove(chunk, chunk + aligned, carry);
     }
+    if(ok && carry != 0)
+        fifo->writeAll(chunk, carry);
 
+    //If CoPro commands fault reboot it
+    if(m_hal->rd16(REG_CMD_READ) == 0xFFF)
+    {
+        rebootCoPro();
+        m_eventFlags.set(CmdBufBusy);
+        m_eventFlags.set(EVEeventFlags::CoProBusy);
+        return false;
+    }
+    m_eventFlags.set(CmdBufBusy);
+    bool idle = waitCoProIdle();
     m_eventFlags.set(EVEeventFlags::CoProBusy);
+    return idle;
+}
+
+void FT8xx::sendCmdBuffer()
+{
+    m_hal->csSet();
+    m_hal->write(static_cast<uint8_t>((REG_CMDB_WRITE) >> 16) | MEM_WRITE);
+    m_hal->write(static_cast<uint8_t>((REG_CMDB_WRITE) >> 8));
+    m_hal->write(static_cast<uint8_t>(REG_CMDB_WRITE));
+    for(const auto & u : m_cmdBuffer)
+    {
+        m_hal->write(u.byte[0]);
+        m_hal->write(u.byte[1]);
+        m_hal->write(u.byte[2]);
+        m_hal->write(u.byte[3]);
+    }
+    m_hal->csClear();
+    m_cmdBuffer.clear();
+    m_ramDLobserver = 0;
+}
+
+bool FT8xx::waitCoProIdle(uint32_t timeout)
+{
+    //Last poll is done after timeout, so short timeouts still check CoPro once
+    for(uint32_t waited = 0;; waited += 10)
+    {
+        if(m_hal->rd16(REG_CMDB_SPACE) == 4092)
+            return true;
+        //Faulted CoPro never frees FIFO
+        if(m_hal->rd16(REG_CMD_READ) == 0xFFF || waited >= timeout)
+            break;
+        ThisThread::sleep_for(10);
+    }
+    rebootCoPro();
+    return false;
+}
+
+uint32_t FT8xx::cmdResult(uint16_t offset)
+{
+    //Results of CoPro commands are written back in place of command arguments
+    uint16_t pointer = m_hal->rd16(REG_CMD_READ);
+    return m_hal->rd32(EVE_RAM_CMD + ((pointer - offset) & 0xFFF));
 }
 
 void FT8xx::clear(bool colorBuf, bool stencilBuf, bool tagBuf)
@@ -837,6 +1011,19 @@ void FT8xx::setBitmap(uint32_t         addr,
                       BitmapExtFormats fmt,
                       uint16_t         width,
                       uint16_t         height)
+{
+    //Current handle doesn't match cached setup anymore
+    if(m_currentHandle < BitmapHandleCount)
+        m_bitmapHandles[m_currentHandle].lastUse = 0;
+    else
+        resetBitmapHandles();
+    pushSetBitmap(addr, fmt, width, height);
+}
+
+void FT8xx::pushSetBitmap(uint32_t         addr,
+                          BitmapExtFormats fmt,
+                          uint16_t         width,
+                          uint16_t         height)
 {
     push(CMD_SETBITMAP);
     push(addr);
@@ -844,6 +1031,52 @@ void FT8xx::setBitmap(uint32_t         addr,
     push({static_cast<int16_t>(height), 0});
 }
 
+uint8_t FT8xx::setAtlas(const Atlas * a)
+{
+    return bindBitmap(a->source(),
+                      a->format(),
+                      a->cellWidth(),
+                      a->cellHeight());
+}
+
+uint8_t FT8xx::bindBitmap(uint32_t         source,
+                          BitmapExtFormats fmt,
+                          uint16_t         width,
+                          uint16_t         height)
+{
+    ++m_bitmapHandleTick;
+    uint8_t victim = 0;
+    for(uint8_t i = 0; i < BitmapHandleCount; ++i)
+    {
+        auto & h = m_bitmapHandles[i];
+        if(h.lastUse != 0
+           && h.source == source
+           && h.format == fmt
+           && h.width == width
+           && h.height == height)
+        {
+            h.lastUse = m_bitmapHandleTick;
+            if(m_currentHandle != i)
+                bitmapHandle(i);
+            return i;
+        }
+        //Free handle has lastUse 0, so it wins over used ones
+        if(h.lastUse < m_bitmapHandles[victim].lastUse)
+            victim = i;
+    }
+
+    if(m_currentHandle != victim)
+        bitmapHandle(victim);
+    pushSetBitmap(source, fmt, width, height);
+    auto & h  = m_bitmapHandles[victim];
+    h.source  = source;
+    h.format  = fmt;
+    h.width   = width;
+    h.height  = height;
+    h.lastUse = m_bitmapHandleTick;
+    return victim;
+}
+
 void FT8xx::getMatrix(int32_t a,
                       int32_t b,
                       int32_t c,
@@ -923,16 +1156,39 @@ void FT8xx::gradientA(int16_t  x0,
 void FT8xx::text(int16_t        x,
                  int16_t        y,
                  uint16_t       font,
-                 const string & text,
+                 TextArg        text,
                  TextOpt        options)
 {
-    if(text.size() == 0)
+    this->text(x, y, font, text.data(), text.size(), options);
+}
+
+void FT8xx::text(int16_t      x,
+                 int16_t      y,
+                 uint16_t     font,
+                 const char * text,
+                 size_t       length,
+                 TextOpt      options)
+{
+    if(length == 0)
         return;
     push(CMD_TEXT);
     push({x, y});
     push({static_cast<int16_t>(font), static_cast<int16_t>(options)});
 
-    writeString(text);
+    writeString(text, length);
+}
+
+void FT8xx::number(int16_t   x,
+                   int16_t   y,
+                   uint16_t  font,
+                   int32_t   n,
+                   NumberOpt options,
+                   uint8_t   digits)
+{
+    push(CMD_NUMBER);
+    push({x, y});
+    push({static_cast<int16_t>(font), static_cast<int16_t>(static_cast<uint16_t>(options) | (digits & 0x1F))});
+    push(n);
 }
 
 void FT8xx::button(int16_t        x,
@@ -940,15 +1196,27 @@ void FT8xx::button(int16_t        x,
                    uint16_t       width,
                    uint16_t       height,
                    uint16_t       font,
-                   const string & text,
+                   TextArg        text,
                    ButtonOpt      options)
+{
+    button(x, y, width, height, font, text.data(), text.size(), options);
+}
+
+void FT8xx::button(int16_t      x,
+                   int16_t      y,
+                   uint16_t     width,
+                   uint16_t     height,
+                   uint16_t     font,
+                   const char * text,
+                   size_t       length,
+                   ButtonOpt    options)
 {
     push(CMD_BUTTON);
     push({x, y});
     push({static_cast<int16_t>(width), static_cast<int16_t>(height)});
     push({static_cast<int16_t>(font), static_cast<int16_t>(options)});
 
-    writeString(text);
+    writeString(text, length);
 }
 
 void FT8xx::clock(int16_t  x,
@@ -1047,15 +1315,35 @@ void FT8xx::toggle(int16_t        x,
                    uint16_t       width,
                    uint16_t       font,
                    uint16_t       state,
-                   const string & offText,
-                   const string & onText,
+                   TextArg        offText,
+                   TextArg        onText,
                    ToggleOpt      options)
+{
+    toggle(x, y, width, font, state, offText.data(), offText.size(), onText.data(), onText.size(), options);
+}
+
+void FT8xx::toggle(int16_t      x,
+                   int16_t      y,
+                   uint16_t     width,
+                   uint16_t     font,
+                   uint16_t     state,
+                   const char * offText,
+                   size_t       offLength,
+                   const char * onText,
+                   size_t       onLength,
+                   ToggleOpt    options)
 {
     push(CMD_TOGGLE);
     push({x, y});
     push({static_cast<int16_t>(width), static_cast<int16_t>(font)});
     push({static_cast<int16_t>(options), static_cast<int16_t>(state)});
-    writeString(offText + "\xff" + onText);
+    //Both labels are packed to one string divided by 0xFF
+    auto         pushWord = [this](uint32_t word) { push(word); };
+    StringPacker packer;
+    packer.add(offText, offLength, pushWord);
+    packer.add("\xff", 1, pushWord);
+    packer.add(onText, onLength, pushWord);
+    packer.finish(pushWord);
 }
 
 void FT8xx::keys(int16_t        x,
@@ -1063,14 +1351,26 @@ void FT8xx::keys(int16_t        x,
                  uint16_t       width,
                  uint16_t       height,
                  uint16_t       font,
-                 const string & text,
+                 TextArg        text,
                  KeysOpt        options)
+{
+    keys(x, y, width, height, font, text.data(), text.size(), options);
+}
+
+void FT8xx::keys(int16_t      x,
+                 int16_t      y,
+                 uint16_t     width,
+                 uint16_t     height,
+                 uint16_t     font,
+                 const char * text,
+                 size_t       length,
+                 KeysOpt      options)
 {
     push(CMD_KEYS);
     push({x, y});
     push({static_cast<int16_t>(width), static_cast<int16_t>(height)});
     push({static_cast<int16_t>(font), static_cast<int16_t>(options)});
-    writeString(text);
+    writeString(text, length);
 }
 
 void FT8xx::spinner(int16_t      x,
@@ -1090,6 +1390,17 @@ void FT8xx::append(uint32_t address, uint32_t count)
     push({static_cast<int32_t>(address)});
     push({static_cast<int32_t>(count)});
     m_ramDLobserver += count - 12;
+    //Appended commands may change any bitmap handle
+    resetBitmapHandles();
+    m_currentHandle = UnknownHandle;
+    m_paletteSource = UnknownPalette;
+}
+
+uint16_t FT8xx::dlOffset()
+{
+    if(m_cmdBuffer.size() != 0)
+        execute();
+    return m_hal->rd16(REG_CMD_DL);
 }
 
 void FT8xx::append(const StoredObject * o)
@@ -1107,12 +1418,35 @@ void FT8xx::append(const StoredObject * o)
         break;
     case StoredObjectType::Sketch:
         append(reinterpret_cast<const Sketch *>(o));
+        break;
     case StoredObjectType::ImagePNG:
-        append(reinterpret_cast<const ImagePNG *>(o));
-        return;
+        append(reinterpret_cast<const ImagePNG *>(o), 0, 0);
+        break;
     case StoredObjectType::ImageJPEG:
+        append(reinterpret_cast<const ImageJPEG *>(o), 0, 0);
+        break;
     case StoredObjectType::CompressedImage:
-        debug("ImageJPEG not supported yet\n");
+        append(reinterpret_cast<const CompressedImage *>(o), 0, 0);
+        break;
+    case StoredObjectType::RawBitmap:
+        append(reinterpret_cast<const RawBitmap *>(o), 0, 0);
+        break;
+    case StoredObjectType::PalettedBitmap:
+        append(reinterpret_cast<const PalettedBitmap *>(o), 0, 0);
+        break;
+    case StoredObjectType::Palette:
+        debug("Palette is not drawable\n");
+        break;
+    case StoredObjectType::Font:
+        debug("Font is drawn with setFont and text\n");
+        break;
+    case StoredObjectType::Atlas:
+        debug("Atlas is drawn with setAtlas and vertexPointII\n");
+        break;
+    case StoredObjectType::FlashBitmap:
+#if defined(BT81X_ENABLE)
+        append(reinterpret_cast<const FlashBitmap *>(o), 0, 0);
+#endif
         break;
     }
 }
@@ -1122,6 +1456,20 @@ void FT8xx::append(const DisplayList * dl)
     append(dl->address(), dl->size());
 }
 
+void FT8xx::append(const DisplayList * dl, int16_t dx, int16_t dy)
+{
+    if(dx == 0 && dy == 0)
+    {
+        append(dl);
+        return;
+    }
+    push(vertexTranslateX(dx * 16));
+    push(vertexTranslateY(dy * 16));
+    append(dl);
+    push(vertexTranslateX(0));
+    push(vertexTranslateY(0));
+}
+
 void FT8xx::append(const Snapshot * s,
                    int16_t          x,
                    int16_t          y,
@@ -1134,14 +1482,40 @@ void FT8xx::append(const Snapshot * s,
         return;
     }
 
-    setBitmap(s->address(),
-              static_cast<BitmapExtFormats>(s->format()),
-              width < 0 ? static_cast<int16_t>(s->width()) : width,
-              height < 0 ? static_cast<int16_t>(s->height()) : height);
+    if(width < 0)
+        width = s->width();
+    if(height < 0)
+        height = s->height();
+    if(s->scale() == 1)
+    {
+        bindBitmap(s->address(),
+                   static_cast<BitmapExtFormats>(s->format()),
+                   width,
+                   height);
+        begin(Bitmaps);
+        vertexPointF(x == -999 ? s->x() : x,
+                     y == -999 ? s->y() : y);
+        this->end();
+        return;
+    }
 
+    bindBitmap(s->address(),
+               static_cast<BitmapExtFormats>(s->format()),
+               s->bitmapWidth(),
+               s->bitmapHeight());
     begin(Bitmaps);
+    //Magnify downscaled snapshot back to captured area
+    push(bitmapSize(Bilinear, Border, Border, width, height));
+    push(bitmapSizeH(width, height));
+    push(bitmapTransformA(256 / s->scale()));
+    push(bitmapTransformE(256 / s->scale()));
     vertexPointF(x == -999 ? s->x() : x,
                  y == -999 ? s->y() : y);
+    //Restore CMD_SETBITMAP setup, so cached handle stays valid
+    push(bitmapSize(Nearest, Border, Border, s->bitmapWidth(), s->bitmapHeight()));
+    push(bitmapSizeH(s->bitmapWidth(), s->bitmapHeight()));
+    push(bitmapTransformA(256));
+    push(bitmapTransformE(256));
     this->end();
 }
 
@@ -1151,14 +1525,15 @@ void FT8xx::append(const Sketch * s,
                    int16_t        width,
                    int16_t        height)
 {
-    setBitmap(s->address(),
-              static_cast<BitmapExtFormats>(s->format()),
-              width < 0 ? static_cast<int16_t>(s->width()) : width,
-              height < 0 ? static_cast<int16_t>(s->height()) : height);
+    uint8_t handle = bindBitmap(s->address(),
+                                static_cast<BitmapExtFormats>(s->format()),
+                                width < 0 ? static_cast<int16_t>(s->width()) : width,
+                                height < 0 ? static_cast<int16_t>(s->height()) : height);
 
     begin(Bitmaps);
     vertexPointII(x < 0 ? s->x() : x,
-                  y < 0 ? s->y() : y);
+                  y < 0 ? s->y() : y,
+                  handle);
     end();
 }
 
@@ -1168,19 +1543,153 @@ void FT8xx::append(const ImagePNG * i,
                    int16_t          width,
                    int16_t          height)
 {
-    setBitmap(i->address(),
-              static_cast<BitmapExtFormats>(i->format()),
-              width < 0 ? static_cast<int16_t>(i->width()) : width,
-              height < 0 ? static_cast<int16_t>(i->height()) : height);
+    bindBitmap(i->address(),
+               static_cast<BitmapExtFormats>(i->format()),
+               width < 0 ? static_cast<int16_t>(i->width()) : width,
+               height < 0 ? static_cast<int16_t>(i->height()) : height);
+    begin(Bitmaps);
+    vertexPointF(x,
+                 y);
+    end();
+}
+
+void FT8xx::append(const ImageJPEG * i,
+                   int16_t           x,
+                   int16_t           y,
+                   int16_t           width,
+                   int16_t           height)
+{
+    bindBitmap(i->address(),
+               static_cast<BitmapExtFormats>(i->format()),
+               width < 0 ? static_cast<int16_t>(i->width()) : width,
+               height < 0 ? static_cast<int16_t>(i->height()) : height);
+    begin(Bitmaps);
+    vertexPointF(x,
+                 y);
+    end();
+}
+
+void FT8xx::append(const CompressedImage * i,
+                   int16_t                 x,
+                   int16_t                 y,
+                   int16_t                 width,
+                   int16_t                 height)
+{
+    bindBitmap(i->address(),
+               i->format(),
+               width < 0 ? static_cast<int16_t>(i->width()) : width,
+               height < 0 ? static_cast<int16_t>(i->height()) : height);
     begin(Bitmaps);
     vertexPointF(x,
                  y);
     end();
 }
 
-void FT8xx::ramGInit(uint32_t size)
+void FT8xx::append(const RawBitmap * i,
+                   int16_t           x,
+                   int16_t           y)
 {
-    m_ramG = new RamG(this, size);
+    bindBitmap(i->address(),
+               i->format(),
+               i->width(),
+               i->height());
+    begin(Bitmaps);
+    vertexPointF(x,
+                 y);
+    end();
+}
+
+#if defined(BT81X_ENABLE)
+void FT8xx::append(const FlashBitmap * i,
+                   int16_t             x,
+                   int16_t             y)
+{
+    bindBitmap(EVE::flashSource(i->address()),
+               i->format(),
+               i->width(),
+               i->height());
+    begin(Bitmaps);
+    vertexPointF(x,
+                 y);
+    end();
+}
+#endif
+
+void FT8xx::append(const PalettedBitmap * i,
+                   int16_t                x,
+                   int16_t                y)
+{
+    const Palette * palette = i->palette();
+    if(palette == nullptr)
+    {
+        debug("Paletted bitmap without palette\n");
+        return;
+    }
+    bindBitmap(i->address(),
+               palette->format(),
+               i->width(),
+               i->height());
+    begin(Bitmaps);
+    if(palette->format() != BitmapExtFormats::PALETTED8)
+    {
+        paletteSource(palette->address());
+        vertexPointF(x,
+                     y);
+        end();
+        return;
+    }
+
+    //PALETTED8 palette is ARGB8: each channel is drawn from its byte of palette entry
+    saveContext();
+    blendFunc(One, Zero);
+    colorMask(0, 0, 0, 1);
+    paletteSource(palette->address() + 3);
+    vertexPointF(x,
+                 y);
+    blendFunc(DstAlpha, OneMinusDstAlpha);
+    colorMask(1, 0, 0, 0);
+    paletteSource(palette->address() + 2);
+    vertexPointF(x,
+                 y);
+    colorMask(0, 1, 0, 0);
+    paletteSource(palette->address() + 1);
+    vertexPointF(x,
+                 y);
+    colorMask(0, 0, 1, 0);
+    paletteSource(palette->address());
+    vertexPointF(x,
+                 y);
+    restoreContext();
+    end();
+}
+
+void FT8xx::setFont(const Font * font)
+{
+    push(CMD_SETFONT2);
+    push(font->handle());
+    push(font->address());
+    push(font->firstChar());
+    m_currentHandle = font->handle();
+    //Handle is taken by font till the end of display list
+    if(font->handle() < BitmapHandleCount)
+    {
+        auto & h  = m_bitmapHandles[font->handle()];
+        h.source  = 0xFFFFFFFF;    //Matches no bitmap
+        h.lastUse = 0xFFFFFFFF;
+    }
+}
+
+void FT8xx::paletteSource(uint32_t addr)
+{
+    if(m_paletteSource == addr)
+        return;
+    push(EVE::paletteSource(addr));
+    m_paletteSource = addr;
+}
+
+void FT8xx::ramGInit(uint32_t size, bool clear)
+{
+    m_ramG = new RamG(this, size, clear);
 }
 //*********************************************************************************
 #if defined(EVE_CAP_TOUCH)
@@ -1225,17 +1734,11 @@ void FT8xx::interruptFound()
 
     if((flag & EVE_INT_TAG) != 0)
     {
-        if(!m_tagCBPool.empty())
+        uint8_t tag = m_hal->rd8(REG_TOUCH_TAG);
+        for(uint8_t i = m_tagFirst[tag]; i != 0; i = m_tagSlots[i - 1].next)
         {
-            uint8_t tag = m_hal->rd8(REG_TOUCH_TAG);
-            for(const auto & cbs : m_tagCBPool)
-            {
-                if(cbs.tagNumber == tag)
-                {
-                    for(const auto & c : cbs.tagCBs)
-                        c->operator()(tag);
-                }
-            }
+            if(m_tagSlots[i - 1].tagCallback)
+                m_tagSlots[i - 1].tagCallback(tag);
         }
     }
 
@@ -1263,18 +1766,11 @@ void FT8xx::interruptFound()
     {
         if(m_touchConvCompCallback)
             m_touchConvCompCallback(flag);
-        if(!m_tagCBPool.empty())
+        auto trackTag = m_hal->rd32(REG_TRACKER);
+        for(uint8_t i = m_tagFirst[trackTag & 0xff]; i != 0; i = m_tagSlots[i - 1].next)
         {
-            auto trackTag = m_hal->rd32(REG_TRACKER);
-            for(const auto & cbs : m_tagCBPool)
-            {
-                if(cbs.tagNumber == (trackTag & 0xff))
-                {
-                    for(const auto & c : cbs.trackCBs)
-                        c->operator()(
-                            static_cast<uint16_t>(trackTag >> 16));
-                }
-            }
+            if(m_tagSlots[i - 1].trackCallback)
+                m_tagSlots[i - 1].trackCallback(static_cast<uint16_t>(trackTag >> 16));
         }
     }
 }
@@ -1324,22 +1820,17 @@ void FT8xx::attach(mbed::Callback<void(uint8_t)> f, uint8_t flag)
 
 void FT8xx::deattachFromTag(uint8_t tag)
 {
-    m_tagCBPool.erase(
-        std::remove_if(
-            m_tagCBPool.begin(),
-            m_tagCBPool.end(),
-            [&](const TagCB & cbs) {
-                if(cbs.tagNumber == tag)
-                {
-                    for(auto & c : cbs.tagCBs)
-                        delete c;
-                    for(auto & c : cbs.trackCBs)
-                        delete c;
-                    return true;
-                }
-                return false;
-            }),
-        m_tagCBPool.end());
+    for(uint8_t i = m_tagFirst[tag]; i != 0;)
+    {
+        auto & slot        = m_tagSlots[i - 1];
+        i                  = slot.next;
+        slot.tagCallback   = nullptr;
+        slot.trackCallback = nullptr;
+        slot.next          = 0;
+    }
+    m_tagFirst[tag] = 0;
+    if(tag != 0 && tag != 255)
+        m_usedTags[tag / 32] &= ~(1u << (tag % 32));
 }
 
 EVE_HAL * FT8xx::hal() const
@@ -1349,102 +1840,71 @@ EVE_HAL * FT8xx::hal() const
 
 uint8_t FT8xx::findFirstEmptyTag()
 {
-    if(m_tagCBPool.empty())
-        return 1;
-
-    std::sort(m_tagCBPool.begin(),
-              m_tagCBPool.end());
-
-    uint8_t next = 1;
-    for(const auto & t : m_tagCBPool)
+    for(uint8_t i = 0; i < TagCount / 32; ++i)
     {
-        if(t.tagNumber != next)
-            return next;
-        ++next;
+        if(m_usedTags[i] != 0xFFFFFFFF)
+            return static_cast<uint8_t>(i * 32 + __builtin_ctz(~m_usedTags[i]));
     }
-    return next;
+    return 0;
 }
 
-uint8_t FT8xx::setCallback(tagCB * f, uint8_t tag)
+uint8_t FT8xx::reserveTag(uint8_t tag)
 {
-    //Check tag pool size
-    if(m_tagCBPool.size() == 254)
-    {
-        debug("TagPool is full");
-        delete f;
-        return 0;
-    }
-
     if(tag == 0)
     {
-        TagCB cbs;
-        cbs.tagNumber = findFirstEmptyTag();
-        cbs.tagCBs.push_back(f);
-        m_tagCBPool.push_back(cbs);
-        return cbs.tagNumber;
-    }
-    else
-    {
-        auto it = std::find_if(m_tagCBPool.begin(),
-                               m_tagCBPool.end(),
-                               [&](const TagCB & c) {
-                                   return c.tagNumber == tag;
-                               });
-        if(it != m_tagCBPool.end())
-        {
-            it->tagCBs.push_back(f);
-            return it->tagNumber;
-        }
-        else
+        tag = findFirstEmptyTag();
+        if(tag == 0)
         {
-            TagCB cbs;
-            cbs.tagNumber = tag;
-            cbs.tagCBs.push_back(f);
-            m_tagCBPool.push_back(cbs);
-            return cbs.tagNumber;
+            debug("TagPool is full");
+            return 0;
         }
     }
+    m_usedTags[tag / 32] |= 1u << (tag % 32);
+    return tag;
 }
 
-uint8_t FT8xx::setTracking(trackCB * f, uint8_t tag)
+FT8xx::TagSlot * FT8xx::addTagSlot(uint8_t & tag)
 {
-    //Check tag pool size
-    if(m_tagCBPool.size() == 254)
+    //Slot without callbacks is free
+    uint8_t index = 0;
+    while(index < EVE_TAG_CALLBACKS
+          && (m_tagSlots[index].tagCallback || m_tagSlots[index].trackCallback))
+        ++index;
+    if(index == EVE_TAG_CALLBACKS)
     {
-        debug("TagPool is full");
-        delete f;
-        return 0;
+        debug("Tag callbacks are full\n");
+        tag = 0;
+        return nullptr;
     }
-
+    tag = reserveTag(tag);
     if(tag == 0)
-    {
-        TagCB cbs;
-        cbs.tagNumber = findFirstEmptyTag();
-        cbs.trackCBs.push_back(f);
-        m_tagCBPool.push_back(cbs);
-        return cbs.tagNumber;
-    }
-    else
-    {
-        auto it = std::find_if(m_tagCBPool.begin(),
-                               m_tagCBPool.end(),
-                               [&](const TagCB & c) {
-                                   return c.tagNumber == tag;
-                               });
-        if(it != m_tagCBPool.end())
-        {
-            it->trackCBs.push_back(f);
-            return it->tagNumber;
-        }
-        else
-        {
-            TagCB cbs;
-            cbs.tagNumber = tag;
-            cbs.trackCBs.push_back(f);
-            m_tagCBPool.push_back(cbs);
-            return cbs.tagNumber;
-        }
-    }
+        return nullptr;
+
+    uint8_t * link = &m_tagFirst[tag];
+    while(*link != 0)
+        link = &m_tagSlots[*link - 1].next;
+    *link = index + 1;
+    return &m_tagSlots[index];
+}
+
+uint8_t FT8xx::setCallback(tagCB f, uint8_t tag)
+{
+    if(!f)
+        return 0;
+    auto slot = addTagSlot(tag);
+    if(slot != nullptr)
+        slot->tagCallback = f;
+    return tag;
+}
+
+uint8_t FT8xx::setTracking(trackCB f, uint8_t tag)
+{
+    if(!f)
+        return 0;
+    auto slot = addTagSlot(tag);
+    if(slot != nullptr)
+        slot->trackCallback = f;
+    return tag;
 }
 
 void FT8xx::p_backlightFade(uint8_t * value, Fade * fade)
@@ -1514,8 +1974,12 @@ void FT8xx::p_animate(int32_t * value,
         break;
     }
     }
+    if(fade->step)
+        fade->step();
     if(fade->cycCount == fade->duration)
     {
+        if(fade->done)
+            fade->done();
         delete fade;
         return;
     }
@@ -36,19 +36,35 @@
 #include <EVE_target.h>
 #include <algorithm>
 #include <ft8xxmemory.h>
+#include <ft8xxstring.h>
 #include <functional>
 #include <vector>
+#if __cplusplus >= 201703L
+    #include <string_view>
+#endif
 
 namespace EVE
 {
+//Text argument of widget commands. C++17 builds take literals and buffers without temporary std::string
+#if __cplusplus >= 201703L
+typedef std::string_view TextArg;
+#else
+typedef const std::string & TextArg;
+#endif
 #if defined(EVE_CAP_TOUCH)
-typedef std::function<void(uint8_t)>  tagCB;
-typedef std::function<void(uint16_t)> trackCB;
+//Kept without heap, so function with bound arguments must fit mbed::Callback storage
+typedef mbed::Callback<void(uint8_t)>  tagCB;
+typedef mbed::Callback<void(uint16_t)> trackCB;
+    #if !defined(EVE_TAG_CALLBACKS)
+        //Count of tag and tracker callbacks attached at once, tags without callbacks don't take it
+        #define EVE_TAG_CALLBACKS 64
+    #endif
 #endif
 class FT8xx : private NonCopyable<FT8xx>
 {
     friend class RamG;
     friend class Flash;
+    friend class MediaFifo;
 
 public:
     enum EVEeventFlags
@@ -139,8 +155,10 @@ public:
     /*!
      * \brief Load cmdBuffer to EVE cmd FIFO and start processing to copy result to Ram_DL
      *  \note now this function support only FT/BT81X, because use new FIFO write mechanism. For more information see BRT_AN_033 page 92.
+     *  \param timeout - time in ms to wait while CoPro finishes. Long commands (f.e. CMD_FLASHERASE) need more
+     *  \return false if commands were dropped or CoPro faulted (it is rebooted then)
      */
-    void execute();
+    bool execute(uint32_t timeout = 1000);
 
     /*!
      * \brief setRotate - Apply screen rotation
@@ -152,7 +170,15 @@ public:
         push(rotation);
     }
 
-    inline void dlStart() { push(CMD_DLSTART); }
+    inline void dlStart()
+    {
+        push(CMD_DLSTART);
+        ++m_frame;
+        resetBitmapHandles();
+        //New display list starts with handle 0 and palette at 0
+        m_currentHandle = 0;
+        m_paletteSource = 0;
+    }
     inline void begin(GraphicPrimitives prim) { push(EVE::begin(prim)); }
     inline void end() { push(EVE::end()); }
     inline void swap()
@@ -225,7 +251,57 @@ public:
                    BitmapExtFormats fmt,
                    uint16_t         width,
                    uint16_t         height);
+
+    /*!
+     * \brief setAtlas - bind atlas cells to bitmap handle with bindBitmap.
+     * Then cells are drawn with vertexPointII(x, y, handle, cell) between begin(Bitmaps) and end()
+     * \param a - atlas
+     * \return bitmap handle
+     */
+    uint8_t setAtlas(const Atlas * a);
+
+    /*!
+     * \brief bindBitmap - select bitmap handle (0...14) set up for the bitmap.
+     * CMD_SETBITMAP is sent only when no handle has the same setup in current display list,
+     * otherwise free or least recently used handle is reused. Handle cache is reset by dlStart()
+     * \return selected bitmap handle
+     */
+    uint8_t bindBitmap(uint32_t         source,
+                       BitmapExtFormats fmt,
+                       uint16_t         width,
+                       uint16_t         height);
 #endif
+#if defined(FT81X_ENABLE)
+    /*!
+     * \brief paletteSource - set PALETTE_SOURCE. Not sent if it is already set in current display list
+     */
+    void paletteSource(uint32_t addr);
+
+    /*!
+     * \brief setFont - register custom font for text commands with CMD_SETFONT2. Must be called in each display list.
+     * Paged extended font needs RamG::requireGlyphs for drawn text
+     */
+    void setFont(const Font * font);
+#endif
+    inline void blendFunc(AlphaBlending src, AlphaBlending dst) { push(EVE::blendFunc(src, dst)); }
+    inline void colorMask(uint8_t r, uint8_t g, uint8_t b, uint8_t a) { push(EVE::colorMask(r, g, b, a)); }
+    inline void saveContext() { push(EVE::SaveContext); }
+    inline void restoreContext()
+    {
+        push(EVE::RestoreContext);
+        //Restored context may have other handle and palette
+        m_currentHandle = UnknownHandle;
+        m_paletteSource = UnknownPalette;
+    }
+    inline void bitmapHandle(uint8_t handle)
+    {
+        push(EVE::bitmapHandle(handle));
+        m_currentHandle = handle;
+    }
+    /*!
+     * \brief resetBitmapHandles - forget bitmap handles setup. Called on new display list
+     */
+    void resetBitmapHandles();
 
     inline void bitmapLayout(BitmapFormats format,
                              uint16_t      linestride,
@@ -301,17 +377,50 @@ public:
     void text(int16_t             x,
               int16_t             y,
               uint16_t            font,
-              const std::string & text,
+              TextArg             text,
               TextOpt             options = TextOpt::CenterXY);
 
+    /*!
+     * \brief text - draw text from any char buffer without building std::string
+     * \param text - not null terminated text
+     * \param length - text length in bytes
+     */
+    void text(int16_t      x,
+              int16_t      y,
+              uint16_t     font,
+              const char * text,
+              size_t       length,
+              TextOpt      options = TextOpt::CenterXY);
+
+    /*!
+     * \brief number - draw decimal number, formatted by CoPro (CMD_NUMBER)
+     * \param n - value, negative needs NumberOpt::Signed
+     * \param digits - minimal count of digits padded by zeros, 0 - no padding
+     */
+    void number(int16_t   x,
+                int16_t   y,
+                uint16_t  font,
+                int32_t   n,
+                NumberOpt options = NumberOpt::CenterXY,
+                uint8_t   digits  = 0);
+
     void button(int16_t             x,
                 int16_t             y,
                 uint16_t            width,
                 uint16_t            height,
                 uint16_t            font    = 27,
-                const std::string & text    = "",
+                TextArg             text    = "",
                 ButtonOpt           options = ButtonOpt::_3D);
 
+    void button(int16_t      x,
+                int16_t      y,
+                uint16_t     width,
+                uint16_t     height,
+                uint16_t     font,
+                const char * text,
+                size_t       length,
+                ButtonOpt    options = ButtonOpt::_3D);
+
     void clock(int16_t  x,
                int16_t  y,
                uint16_t radius,
@@ -367,18 +476,38 @@ public:
                 uint16_t            width,
                 uint16_t            font,
                 uint16_t            state,
-                const std::string & offText = "",
-                const std::string & onText  = "",
+                TextArg             offText = "",
+                TextArg             onText  = "",
                 ToggleOpt           options = ToggleOpt::_3D);
 
+    void toggle(int16_t      x,
+                int16_t      y,
+                uint16_t     width,
+                uint16_t     font,
+                uint16_t     state,
+                const char * offText,
+                size_t       offLength,
+                const char * onText,
+                size_t       onLength,
+                ToggleOpt    options = ToggleOpt::_3D);
+
     void keys(int16_t             x,
               int16_t             y,
               uint16_t            width,
               uint16_t            height,
               uint16_t            font,
-              const std::string & text    = "",
+              TextArg             text    = "",
               KeysOpt             options = KeysOpt::_3D);
 
+    void keys(int16_t      x,
+              int16_t      y,
+              uint16_t     width,
+              uint16_t     height,
+              uint16_t     font,
+              const char * text,
+              size_t       length,
+              KeysOpt      options = KeysOpt::_3D);
+
     void spinner(int16_t      x     = EVE_HSIZE / 2,
                  int16_t      y     = EVE_VSIZE / 2,
                  SpinnerOpt   style = SpinnerOpt::Circle,
@@ -399,6 +528,18 @@ public:
     void append(const StoredObject * o);
 
     void append(const DisplayList * dl);
+    /*!
+     * \brief append - append display list moved by VERTEX_TRANSLATE
+     * \param dx, dy - offset in pixels
+     */
+    void append(const DisplayList * dl, int16_t dx, int16_t dy);
+
+    /*!
+     * \brief dlOffset - send pending commands and return write offset of CoPro in Ram_DL (REG_CMD_DL).
+     * Display list produced by CoPro between two offsets can be stored by RamG::saveFragment
+     */
+    uint16_t dlOffset();
+
     void append(const Snapshot * s,
                 int16_t          x      = -999,
                 int16_t          y      = -999,
@@ -416,19 +557,62 @@ public:
                 int16_t          y,
                 int16_t          width  = -1,
                 int16_t          height = -1);
+
+    void append(const ImageJPEG * i,
+                int16_t           x,
+                int16_t           y,
+                int16_t           width  = -1,
+                int16_t           height = -1);
+
+    void append(const CompressedImage * i,
+                int16_t                 x,
+                int16_t                 y,
+                int16_t                 width  = -1,
+                int16_t                 height = -1);
+
+    void append(const RawBitmap * i,
+                int16_t           x,
+                int16_t           y);
+
+    /*!
+     * \brief append - draw paletted bitmap. PALETTED8 is drawn in 4 passes (alpha, red, green, blue)
+     */
+    void append(const PalettedBitmap * i,
+                int16_t                x,
+                int16_t                y);
+#if defined(BT81X_ENABLE)
+    /*!
+     * \brief append - draw ASTC bitmap straight from flash
+     */
+    void append(const FlashBitmap * i,
+                int16_t             x,
+                int16_t             y);
+#endif
 #endif
 
     //**************************
 
     //***********Ram G Commands
-    void         ramGInit(uint32_t size = EVE_RAM_G_SAFETY_SIZE);
+    /*!
+     * \brief ramGInit - start Ram_G storage
+     * \param size - allocated size
+     * \param clear - zero Ram_G. False keeps data loaded before warm reset, so loaders can skip it by CRC
+     */
+    void         ramGInit(uint32_t size  = EVE_RAM_G_SAFETY_SIZE,
+                          bool     clear = true);
     const RamG * ramG();
     //****************
 
 #if defined(BT81X_ENABLE)
     //***********Flash commands
-    uint8_t flashInit(uint32_t size);
-        //****************
+    /*!
+     * \brief flashInit - attach flash in full mode and read asset directory
+     * \param size - flash size in bytes
+     * \param directory - flash address of asset directory (eve_asset_pack.py --base)
+     */
+    uint8_t       flashInit(uint32_t size, uint32_t directory = FlashAssetDirectory);
+    const Flash * flash();
+    //****************
 #endif
 
     uint8_t backlight();
@@ -455,6 +639,28 @@ public:
      */
     int32_t touchXY();
 
+    /*!
+     * \brief touchTag read tag of object under touch point
+     * \return tag, 0 if no touch present or object has no tag
+     */
+    uint8_t touchTag();
+
+#if defined(FT81X_ENABLE)
+    static constexpr uint8_t MaxTouchPoints = 5;
+
+    /*!
+     * \brief setExtendedTouch - switch capacitive touch controller to extended mode with up to 5 touch points
+     */
+    void setExtendedTouch(bool enable);
+
+    /*!
+     * \brief touchPoints - read all touch points of extended mode with one burst of touch registers
+     * \param x, y - coordinates, -32768 if finger is not present
+     * \return bit per present finger
+     */
+    uint8_t touchPoints(int16_t x[MaxTouchPoints], int16_t y[MaxTouchPoints]);
+#endif
+
     /*!
      * \brief touchCalibrate - function for calibrate touchscreen
      * \param factory - if true - load factory calibration, else - start new calibration
@@ -470,13 +676,18 @@ public:
      * \param duration - time to animation in ms
      * \param fadeType - easing
      * \param delay - delay between every steps of animation in ms. Decrease this value for smooth or increace for performance
+     * \param step - called after every change of value, f.e. to invalidate values calculated from it
+     * \param done - called after final value is written
+     * \note step and done are called from driver event thread
      */
-    void animate(int32_t * value,
-                 int32_t   from,
-                 int32_t   to,
-                 uint32_t  duration = 1000,
-                 FadeType  fadeType = Linear,
-                 uint8_t   delay    = 10);
+    void animate(int32_t *              value,
+                 int32_t                from,
+                 int32_t                to,
+                 uint32_t               duration = 1000,
+                 FadeType               fadeType = Linear,
+                 uint8_t                delay    = 10,
+                 mbed::Callback<void()> step     = nullptr,
+                 mbed::Callback<void()> done     = nullptr);
 
     /*!
      * \brief backlightFade - change screen backlight PWM duty cycle with specific time and easing
@@ -523,7 +734,15 @@ public:
     void deattachFromTag(uint8_t tag);
 
     /*!
-     * \brief setCallbackToTag. Attach callback to tag
+     * \brief allocateTag. Reserve free tag without callbacks, f.e. for host side hit testing. Release it with deattachFromTag
+     * \return Tag number, 0 if all tags are used
+     */
+    inline uint8_t allocateTag() { return reserveTag(0); }
+
+    /*!
+     * \brief setCallbackToTag. Attach callback to tag. Callbacks are stored in mbed::Callback, so bound args must fit
+     * its storage together with function (f.e. function pointer and one argument).
+     * Up to EVE_TAG_CALLBACKS callbacks and trackers are attached at once
      * \param f - callback function will be attached to tag. Last argument in function must be uint8_t for passing tag number
      * \param tag - tag number for adding. if it is 0 - automatic add callback to first empty tag
      * \param args - arguments of callback, if provided
@@ -532,11 +751,11 @@ public:
     template<typename F, typename... Args>
     uint8_t setCallbackToTag(F && f, uint8_t tag = 0, Args... args)
     {
-        auto * fp = new tagCB(
+        return setCallback(
             [f, args...](uint8_t tag) -> void {
                 (f)(args..., tag);
-            });
-        return setCallback(fp, tag);
+            },
+            tag);
     }
 
     /*!
@@ -561,11 +780,11 @@ public:
                      Args... args)
     {
         //Wrap callback with different args type
-        auto * fp = new tagCB(
+        return setCallback(
             [obj, method, args...](uint8_t tag) -> void {
                 (obj->*method)(args..., tag);
-            });
-        return setCallback(fp, tag);
+            },
+            tag);
     }
     /*!
      * \brief setCallbackToTag. Attach member function for callback to tag.
@@ -589,11 +808,11 @@ public:
                      Args... args)
     {
         //Wrap callback with different args type
-        auto * fp = new tagCB(
+        return setCallback(
             [obj, method, args...](uint8_t) -> void {
                 (obj->*method)(args...);
-            });
-        return setCallback(fp, tag);
+            },
+            tag);
     }
 
     /*!
@@ -613,11 +832,11 @@ public:
                      Args... args)
     {
         //Wrap callback with different args type
-        auto * fp = new tagCB(
+        return setCallback(
             [f, args...](uint8_t) -> void {
                 (*f)(args...);
-            });
-        return setCallback(fp, tag);
+            },
+            tag);
     }
 
     //*******************
@@ -633,11 +852,11 @@ public:
                              uint8_t tag = 0,
                              Args... args)
     {
-        auto * fp = new trackCB(
+        return setTracking(
             [f, args...](uint16_t value) -> void {
                 (f)(args..., value);
-            });
-        return setTracking(fp, tag);
+            },
+            tag);
     }
 
     template<typename R,
@@ -651,17 +870,21 @@ public:
                              Args... args)
     {
         //Wrap callback with different args type
-        auto * fp = new trackCB(
+        return setTracking(
             [obj, method, args...](uint16_t value) -> void {
                 (obj->*method)(args..., value);
-            });
-        return setTracking(fp, tag);
+            },
+            tag);
     }
 
 #endif
     //**************************************************************
 
     EVE_HAL * hal() const;
+    /*!
+     * \brief frame - count of display lists started with dlStart
+     */
+    inline uint32_t frame() const { return m_frame; }
 
 private:
     EVE_HAL * m_hal{nullptr};
@@ -669,13 +892,67 @@ private:
 #if defined(BT81X_ENABLE)
     Flash * m_flash{nullptr};
 #endif
+    //Bitmap handles 0...14 managed by bindBitmap. 15 is CoPro scratch, 16...31 - ROM fonts
+    struct BitmapHandleState
+    {
+        uint32_t         source{0};
+        BitmapExtFormats format{BitmapExtFormats::ARGB1555};
+        uint16_t         width{0},
+            height{0};
+        uint32_t lastUse{0};    //0 - handle is free
+    };
+    static constexpr uint8_t BitmapHandleCount = 15;
+    static constexpr uint8_t UnknownHandle     = 0xFF;
+
+    BitmapHandleState m_bitmapHandles[BitmapHandleCount];
+    uint32_t          m_bitmapHandleTick{0};
+    uint8_t           m_currentHandle{0};
+
+    static constexpr uint32_t UnknownPalette = 0xFFFFFFFF;
+    uint32_t                  m_paletteSource{0};
+    //Count of display lists, glyph pages used by current and displayed ones are not replaced
+    uint32_t m_frame{0};
+
     PixelPrecision        m_pixelPrecision{Div_16};
     std::vector<CmdBuf_t> m_cmdBuffer;
     uint16_t              m_ramDLobserver{0};
     EventFlags            m_eventFlags;
 
     void rebootCoPro();
-    void writeString(const string & text);
+    void writeString(const char * text, size_t length);
+#if defined(FT81X_ENABLE)
+    void pushSetBitmap(uint32_t         addr,
+                       BitmapExtFormats fmt,
+                       uint16_t         width,
+                       uint16_t         height);
+#endif
+
+    /*!
+     * \brief writeData - send cmdBuffer followed by raw data payload (f.e. image for CMD_LOADIMAGE) to CoPro FIFO with burst SPI writes
+     * \param data - pointer to payload
+     * \param size - payload size in bytes. Payload is padded with zeros to 4 bytes
+     * \return false if CoPro faulted
+     */
+    bool writeData(const uint8_t * data, uint32_t size);
+    /*!
+     * \brief writeStream - send cmdBuffer to CoPro FIFO and feed command data through MediaFIFO
+     * \param fifo - started MediaFIFO
+     * \param producer - callback returns next chunks of data
+     * \return false if CoPro faulted
+     */
+    bool writeStream(MediaFifo * fifo, DataProducer producer);
+    void sendCmdBuffer();
+    /*!
+     * \brief waitCoProIdle - poll CoPro FIFO at least once, reboot CoPro on fault or timeout
+     * \return false if CoPro was rebooted
+     */
+    bool waitCoProIdle(uint32_t timeout = 1000);
+
+    /*!
+     * \brief cmdResult - read result of last executed command from CoPro FIFO
+     * \param offset - offset in bytes back from REG_CMD_READ
+     */
+    uint32_t cmdResult(uint16_t offset);
 #if defined(FT81X_ENABLE)
     void append(uint32_t address, uint32_t count);
 #endif
@@ -685,8 +962,10 @@ private:
     void    interruptFound();
     uint8_t findFirstEmptyTag();
 
-    uint8_t setCallback(tagCB * f, uint8_t tag);
-    uint8_t setTracking(trackCB * f, uint8_t tag);
+    uint8_t setCallback(tagCB f, uint8_t tag);
+    uint8_t setTracking(trackCB f, uint8_t tag);
+    //Mark tag as used, 0 - no free tags
+    uint8_t reserveTag(uint8_t tag);
 
     struct Fade
     {
@@ -696,19 +975,23 @@ private:
         int32_t  start;
         uint8_t  freq;
         FadeType fadeType;
+
+        mbed::Callback<void()> step{nullptr};
+        mbed::Callback<void()> done{nullptr};
     };
 
-    struct TagCB
+    //Callback of tag in fixed pool. Few callbacks on one tag are linked in attach order
+    struct TagSlot
     {
-        uint8_t                tagNumber;
-        std::vector<tagCB *>   tagCBs;
-        std::vector<trackCB *> trackCBs;
-
-        bool operator<(const TagCB & c) const
-        {
-            return (tagNumber < c.tagNumber);
-        }
+        tagCB   tagCallback{nullptr};
+        trackCB trackCallback{nullptr};
+        uint8_t next{0};    //Slot number + 1 of next callback on the same tag, 0 - last
     };
+    static constexpr uint16_t TagCount = 256;
+    static_assert(EVE_TAG_CALLBACKS < 256, "EVE_TAG_CALLBACKS must be less than 256");
+
+    //Link free slot to end of tag chain. Tag is reserved if slot is found, nullptr and tag 0 if not
+    TagSlot * addTagSlot(uint8_t & tag);
 
     void p_backlightFade(uint8_t * value, Fade * fade);
     void p_animate(int32_t * value, Fade * fade);
@@ -723,7 +1006,11 @@ private:
     mbed::Callback<void(uint8_t)> m_touchDetectedCallback{nullptr};
     mbed::Callback<void(uint8_t)> m_touchConvCompCallback{nullptr};
 
-    std::vector<TagCB> m_tagCBPool;
+    TagSlot m_tagSlots[EVE_TAG_CALLBACKS];
+    //Slot number + 1 of first callback of each tag, 0 - no callbacks
+    uint8_t m_tagFirst[TagCount]{};
+    //Bit per tag, 1 - tag is used. Tag 0 (no tag) and 255 (default tag) are never given
+    uint32_t m_usedTags[TagCount / 32]{0x00000001, 0, 0, 0, 0, 0, 0, 0x80000000};
 #endif
 };
 }    // namespace EVE
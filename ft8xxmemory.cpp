@@ -2,9 +2,81 @@
 
 #include <ft8xx.h>
 
+#if defined(FT81X_ENABLE) && !defined(EVE_RAM_PNG_BUFFER)
+    //FT81x overwrites the same top 42K of Ram_G while decoding PNG
+    #define EVE_RAM_PNG_BUFFER 0x0F5800UL
+#endif
+
 using namespace EVE;
 
-RamG::RamG(FT8xx * parent, uint32_t size = EVE_RAM_G_SAFETY_SIZE) :
+namespace
+{
+/* Data source for MediaFIFO: already read head of file goes first, then rest is taken from producer */
+struct ChunkSource
+{
+    ChunkSource(const uint8_t * head, uint32_t headSize, DataProducer tail) :
+        m_head(head), m_headSize(headSize), m_tail(tail) {}
+
+    uint32_t read(uint8_t * buffer, uint32_t size)
+    {
+        if(m_position < m_headSize)
+        {
+            uint32_t len = std::min(size, m_headSize - m_position);
+            memcpy(buffer, m_head + m_position, len);
+            m_position += len;
+            return len;
+        }
+        return m_tail ? m_tail(buffer, size) : 0;
+    }
+
+    const uint8_t * m_head;
+    uint32_t        m_headSize;
+    uint32_t        m_position{0};
+    DataProducer    m_tail;
+};
+
+bool isASTC(BitmapExtFormats format)
+{
+    return static_cast<uint32_t>(format) >= static_cast<uint32_t>(BitmapExtFormats::COMPRESSED_RGBA_ASTC_4x4_KHR)
+           && static_cast<uint32_t>(format) <= static_cast<uint32_t>(BitmapExtFormats::COMPRESSED_RGBA_ASTC_12x12_KHR);
+}
+
+/* Byte size of bitmap with given format */
+uint32_t bitmapByteSize(BitmapExtFormats format, uint16_t width, uint16_t height)
+{
+    if(isASTC(format))
+    {
+        //ASTC block sizes in order of formats, 16 bytes per block
+        static const uint8_t blocks[][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+        auto b = blocks[static_cast<uint32_t>(format) - static_cast<uint32_t>(BitmapExtFormats::COMPRESSED_RGBA_ASTC_4x4_KHR)];
+        return ((width + b[0] - 1) / b[0]) * ((height + b[1] - 1) / b[1]) * 16;
+    }
+    uint32_t bits;
+    switch(format)
+    {
+    case BitmapExtFormats::L1:
+        bits = 1;
+        break;
+    case BitmapExtFormats::L2:
+        bits = 2;
+        break;
+    case BitmapExtFormats::L4:
+        bits = 4;
+        break;
+    case BitmapExtFormats::ARGB1555:
+    case BitmapExtFormats::ARGB4:
+    case BitmapExtFormats::RGB565:
+        bits = 16;
+        break;
+    default:
+        bits = 8;
+        break;
+    }
+    return ((width * bits + 7) / 8) * height;
+}
+}    // namespace
+
+RamG::RamG(FT8xx * parent, uint32_t size = EVE_RAM_G_SAFETY_SIZE, bool clear) :
     m_parent(parent)
 {
     if(size > EVE_RAM_G_SIZE)
@@ -16,7 +88,8 @@ RamG::RamG(FT8xx * parent, uint32_t size = EVE_RAM_G_SAFETY_SIZE) :
         "process. \n\n");
     m_start = EVE_RAM_G;
     m_size  = m_start + size;
-    memZero(m_start, m_size);
+    if(clear)
+        memZero(m_start, m_size);
 }
 
 DisplayList * RamG::saveDisplayList(string name) const
@@ -43,6 +116,18 @@ DisplayList * RamG::saveDisplayList(string name) const
         //        }
     }
 
+    if(m_deduplicate)
+    {
+        list->setHash(memCrc(EVE_RAM_DL, list->size()));
+        if(auto same = findDuplicate(list))
+        {
+            m_parent->m_hal->wr16(REG_CMD_DL, 0);
+            delete list;
+            same->addRef();
+            return static_cast<DisplayList *>(same);
+        }
+    }
+
     if(list->address() + list->size() > this->m_size)
     {
         error("Display List more than RamG free space!\n");
@@ -54,6 +139,37 @@ DisplayList * RamG::saveDisplayList(string name) const
     return list;
 }
 
+DisplayList * RamG::saveFragment(string name, uint16_t start) const
+{
+    uint16_t end = m_parent->dlOffset();
+    if(end <= start)
+    {
+        debug("Nothing to store. Exit \n");
+        return nullptr;
+    }
+    auto * list = new DisplayList(name,
+                                  this->m_currentPosition,
+                                  end - start);
+    if(m_deduplicate)
+    {
+        list->setHash(memCrc(EVE_RAM_DL + start, list->size()));
+        if(auto same = findDuplicate(list))
+        {
+            delete list;
+            same->addRef();
+            return static_cast<DisplayList *>(same);
+        }
+    }
+    if(list->address() + list->size() > this->m_size)
+    {
+        error("Display List more than RamG free space!\n");
+    }
+    memCopy(list->address(), EVE_RAM_DL + start, list->size());
+    this->m_currentPosition += list->size();
+    m_pool.push_back(list);
+    return list;
+}
+
 DisplayList * RamG::updateDisplayList(DisplayList * list) const
 {
     //Check if DL memory have data to store
@@ -70,13 +186,15 @@ DisplayList * RamG::updateDisplayList(DisplayList * list) const
         }
     }
 
-    if(dlSize > list->size())
+    //Shared list is used by other owners too, so it is not changed in place
+    if(dlSize > list->size() || list->refCount() > 1)
     {
-        debug("Current DL is more than stored. Store new\n");
+        debug_if(dlSize > list->size(), "Current DL is more than stored. Store new\n");
         auto newList = saveDisplayList(list->name());
         removeDisplayList(list);
         return newList;
     }
+    list->setHash(m_deduplicate ? memCrc(EVE_RAM_DL, list->size()) : 0);
     memCopy(list->address(), EVE_RAM_DL, list->size());
     m_parent->m_hal->wr16(REG_CMD_DL, 0);
     return list;
@@ -87,7 +205,8 @@ Snapshot * RamG::saveSnapshot(std::string          name,
                               int16_t              x,
                               int16_t              y,
                               uint16_t             width,
-                              uint16_t             height) const
+                              uint16_t             height,
+                              uint8_t              scale) const
 {
     if(m_parent->m_cmdBuffer.size() != 0)
     {
@@ -99,6 +218,12 @@ Snapshot * RamG::saveSnapshot(std::string          name,
         width = EVE_HSIZE - x;
     if(y + height > EVE_VSIZE)
         height = EVE_VSIZE - y;
+    //ARGB8 snapshot can't be drawn as bitmap to scale it
+    if(fmt == SnapshotBitmapFormat::ARGB8 && scale > 1)
+    {
+        debug("ARGB8 snapshot can't be scaled\n");
+        scale = 1;
+    }
 
     auto * snapshot = new Snapshot(name,
                                    this->m_currentPosition,
@@ -106,21 +231,38 @@ Snapshot * RamG::saveSnapshot(std::string          name,
                                    y,
                                    width,
                                    height,
-                                   fmt);
+                                   fmt,
+                                   scale);
+    if(snapshot->scale() > 1 && !stripFits(snapshot))
+    {
+        debug("Not enough RamG to scale snapshot, full size is taken\n");
+        delete snapshot;
+        snapshot = new Snapshot(name,
+                                this->m_currentPosition,
+                                x,
+                                y,
+                                width,
+                                height,
+                                fmt);
+    }
     if(snapshot->address() + snapshot->size() > this->m_size)
     {
         error("Snapshot more than RamG free space!\n");
     }
 
-    m_parent->push(CMD_SNAPSHOT2);                 //Snapshot command
-    m_parent->push(static_cast<uint32_t>(fmt));    //Bitmap Format
-    m_parent->push(this->m_currentPosition);       //Pointer to RamG address
-    m_parent->push({x, y});                        //Position
-    m_parent->push({fmt == SnapshotBitmapFormat::ARGB8
-                        ? static_cast<int16_t>(width * 2u)
-                        : static_cast<int16_t>(width),    //Bitmap Format
-                    static_cast<int16_t>(height)});       // Size
-    m_parent->execute();                                  //Take a snapsot
+    captureSnapshot(snapshot);
+
+    if(m_deduplicate)
+    {
+        snapshot->setHash(memCrc(snapshot->address(), snapshot->size()));
+        //Data after current position is free space, nothing to clean
+        if(auto same = findDuplicate(snapshot))
+        {
+            delete snapshot;
+            same->addRef();
+            return static_cast<Snapshot *>(same);
+        }
+    }
 
     //    debug("Size: %lu, %u\n", EVE_RAM_G_SAFETY_SIZE, snapshot->size());
     //increace current position
@@ -132,23 +274,169 @@ Snapshot * RamG::saveSnapshot(std::string          name,
 
 Snapshot * RamG::updateSnapshot(Snapshot * s) const
 {
+    //Shared snapshot is used by other owners too, so it is not changed in place.
+    //Scaled one without room for strips is taken again at full size
+    if(s->refCount() > 1 || (s->scale() > 1 && !stripFits(s)))
+    {
+        auto newSnapshot = saveSnapshot(s->name(),
+                                        s->format(),
+                                        s->x(),
+                                        s->y(),
+                                        s->width(),
+                                        s->height(),
+                                        s->scale());
+        removeSnapshot(s);
+        return newSnapshot;
+    }
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    captureSnapshot(s);
+    s->setHash(m_deduplicate ? memCrc(s->address(), s->size()) : 0);
+    return s;
+}
+
+Snapshot * RamG::updateSnapshot(Snapshot * s,
+                                int16_t    x,
+                                int16_t    y,
+                                uint16_t   width,
+                                uint16_t   height) const
+{
+    if(s->refCount() > 1 || s->scale() > 1)
+        return updateSnapshot(s);
+
+    //Clip dirty rectangle by snapshot area
+    int16_t left   = std::max(x, s->x());
+    int16_t top    = std::max(y, s->y());
+    int16_t right  = std::min<int16_t>(x + width, s->x() + s->width());
+    int16_t bottom = std::min<int16_t>(y + height, s->y() + s->height());
+    if(left >= right || top >= bottom)
+        return s;
+
     if(m_parent->m_cmdBuffer.size() != 0)
     {
         m_parent->m_hal->wr16(REG_CMD_DL, 0);
         m_parent->execute();
     }
-    m_parent->push(CMD_SNAPSHOT2);                         //Snapshot command
-    m_parent->push(static_cast<uint32_t>(s->format()));    //Bitmap Format
-    m_parent->push(s->address());                          //Pointer to RamG address
-    m_parent->push({s->x(), s->y()});                      //Position
-    m_parent->push({s->format() == SnapshotBitmapFormat::ARGB8
-                        ? static_cast<int16_t>(s->width() * 2u)
-                        : static_cast<int16_t>(s->width()),    //Bitmap Format
-                    static_cast<int16_t>(s->height())});       // Size
-    m_parent->execute();                                       //Take a snapsot
+    uint16_t rectWidth  = right - left;
+    uint16_t rectHeight = bottom - top;
+    uint32_t stride     = s->width() * s->pixelSize();
+    uint32_t lineSize   = rectWidth * s->pixelSize();
+    uint32_t dest       = s->address()
+                    + (top - s->y()) * stride
+                    + (left - s->x()) * s->pixelSize();
+
+    //Full width lines are continuous in bitmap
+    if(rectWidth == s->width())
+    {
+        takeSnapshot(s->format(), dest, left, top, rectWidth, rectHeight);
+    }
+    else
+    {
+        uint32_t scratch = m_currentPosition;
+        if(scratch + lineSize * rectHeight > m_size)
+            return updateSnapshot(s);
+        takeSnapshot(s->format(), scratch, left, top, rectWidth, rectHeight);
+        //Put lines to bitmap with its linestride. Few lines per burst to fit CoPro FIFO
+        for(uint16_t line = 0; line < rectHeight; ++line)
+        {
+            m_parent->push(CMD_MEMCPY);
+            m_parent->push(dest + line * stride);
+            m_parent->push(scratch + line * lineSize);
+            m_parent->push(lineSize);
+            if((line & 0x1F) == 0x1F)
+                m_parent->execute();
+        }
+        if(m_parent->m_cmdBuffer.size() != 0)
+            m_parent->execute();
+    }
+    s->setHash(m_deduplicate ? memCrc(s->address(), s->size()) : 0);
     return s;
 }
 
+void RamG::takeSnapshot(SnapshotBitmapFormat fmt,
+                        uint32_t             ptr,
+                        int16_t              x,
+                        int16_t              y,
+                        uint16_t             width,
+                        uint16_t             height) const
+{
+    m_parent->push(CMD_SNAPSHOT2);                 //Snapshot command
+    m_parent->push(static_cast<uint32_t>(fmt));    //Bitmap Format
+    m_parent->push(ptr);                           //Pointer to RamG address
+    m_parent->push({x, y});                        //Position
+    m_parent->push({fmt == SnapshotBitmapFormat::ARGB8
+                        ? static_cast<int16_t>(width * 2u)
+                        : static_cast<int16_t>(width),    //Bitmap Format
+                    static_cast<int16_t>(height)});       // Size
+    m_parent->execute();                                  //Take a snapsot
+}
+
+void RamG::captureSnapshot(const Snapshot * s) const
+{
+    if(s->scale() == 1)
+    {
+        takeSnapshot(s->format(), s->address(), s->x(), s->y(), s->width(), s->height());
+        return;
+    }
+    //Area is captured by strips of scale lines to free Ram_G and each scale x scale block is averaged here.
+    //Nothing is drawn, so displayed list and GUI thread are not touched
+    //Callers check stripFits before
+    uint8_t  scale      = s->scale();
+    uint16_t width      = s->bitmapWidth();
+    uint32_t stripWidth = width * scale;
+    uint32_t stripSize  = stripWidth * scale * s->pixelSize();
+    uint32_t scratch    = std::max(m_currentPosition, s->address() + s->size());
+    //Colour channels of 16 bit pixel
+    static const uint16_t masksRGB565[] = {0xF800, 0x07E0, 0x001F, 0};
+    static const uint16_t masksARGB4[]  = {0xF000, 0x0F00, 0x00F0, 0x000F};
+    const uint16_t *      masks         = s->format() == SnapshotBitmapFormat::RGB565 ? masksRGB565 : masksARGB4;
+
+    std::vector<uint8_t>  strip(stripSize);
+    std::vector<uint16_t> line(width);
+    for(uint16_t row = 0; row < s->bitmapHeight(); ++row)
+    {
+        takeSnapshot(s->format(),
+                     scratch,
+                     s->x(),
+                     static_cast<int16_t>(s->y() + row * scale),
+                     static_cast<uint16_t>(stripWidth),
+                     scale);
+        m_parent->m_hal->rdByteBuffer(scratch, strip.data(), static_cast<uint16_t>(stripSize));
+        for(uint16_t column = 0; column < width; ++column)
+        {
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for(uint8_t dy = 0; dy < scale; ++dy)
+            {
+                for(uint8_t dx = 0; dx < scale; ++dx)
+                {
+                    uint32_t i     = (dy * stripWidth + column * scale + dx) * 2;
+                    uint16_t pixel = strip[i] | (strip[i + 1] << 8);
+                    for(uint8_t c = 0; c < 4; ++c)
+                        sum[c] += pixel & masks[c];
+                }
+            }
+            uint16_t pixel = 0;
+            for(uint8_t c = 0; c < 4; ++c)
+                pixel |= (sum[c] / (scale * scale)) & masks[c];
+            line[column] = pixel;
+        }
+        m_parent->m_hal->wrByteBuffer(s->address() + row * width * 2,
+                                      reinterpret_cast<const uint8_t *>(line.data()),
+                                      static_cast<uint16_t>(width * 2));
+    }
+}
+
+bool RamG::stripFits(const Snapshot * s) const
+{
+    //Strip of scale full size lines behind snapshot and everything allocated, read back in one SPI burst
+    uint32_t stripSize = s->bitmapWidth() * s->scale() * s->scale() * s->pixelSize();
+    uint32_t scratch   = std::max(m_currentPosition, s->address() + s->size());
+    return scratch + stripSize <= m_size && stripSize <= 0xFFFF;
+}
+
 Sketch * RamG::startSketch(string             name,
                            SketchBitmapFormat fmt,
                            int16_t            x,
@@ -194,156 +482,1218 @@ Sketch * RamG::startSketch(string             name,
 
 ImagePNG * RamG::loadPNG(string          name,
                          const uint8_t * src,
-                         ImagePNGFormat  fmt,
-                         uint16_t        width,
-                         uint16_t        height,
+                         uint32_t        size,
                          LoadImageOpt    opt) const
 {
+    return decodePNG(name, src, size, nullptr, opt);
+}
+
+ImagePNG * RamG::loadPNG(string       name,
+                         DataProducer producer,
+                         LoadImageOpt opt) const
+{
+    //Collect PNG signature and IHDR chunk to get image size and format
+    uint8_t  head[PNGHeaderSize];
+    uint32_t headSize = 0;
+    while(headSize < PNGHeaderSize)
+    {
+        uint32_t len = producer(head + headSize, PNGHeaderSize - headSize);
+        if(len == 0)
+            break;
+        headSize += len;
+    }
+    return decodePNG(name,
+                     head,
+                     headSize,
+                     producer,
+                     static_cast<LoadImageOpt>(static_cast<uint32_t>(opt)
+                                               | static_cast<uint32_t>(LoadImageOpt::MediaFIFO)));
+}
+
+ImagePNG * RamG::decodePNG(string          name,
+                           const uint8_t * head,
+                           uint32_t        headSize,
+                           DataProducer    tail,
+                           LoadImageOpt    opt) const
+{
+#if !defined(FT81X_ENABLE) && !defined(BT81X_ENABLE)
+    //FT80x CMD_LOADIMAGE decodes JPEG only
+    (void)head;
+    (void)headSize;
+    (void)tail;
+    (void)opt;
+    debug("PNG decoding needs FT81x or later, \"%s\" not loaded\n", name.c_str());
+    return nullptr;
+#else
     if(m_parent->m_cmdBuffer.size() != 0)
     {
         m_parent->m_hal->wr16(REG_CMD_DL, 0);
         m_parent->execute();
     }
-#if defined(BT81X_ENABLE)
-    if(((static_cast<uint32_t>(opt)
-         & static_cast<uint32_t>(LoadImageOpt::MediaFIFO))
-        == 0)
-       && ((static_cast<uint32_t>(opt) & static_cast<uint32_t>(LoadImageOpt::Flash)) == 0)) /* direct data, neither by Media-FIFO or from Flash */
-#elif defined(FT81X_ENABLE)
-    if((static_cast<uint32_t>(opt) & static_cast<uint32_t>(LoadImageOpt::MediaFIFO)) == 0) /* direct data, not by Media-FIFO */
-#endif
+    if((static_cast<uint32_t>(opt) & static_cast<uint32_t>(LoadImageOpt::Flash)) != 0)
     {
-        auto png = new ImagePNG(name,
-                                this->m_currentPosition,
-                                width,
-                                height,
-                                fmt);
-        if(png->address() + png->size() > this->m_size)
-        {
-            error("PNG Image more than RamG free space!\n");
-        }
-        //        uint32_t o = static_cast<uint32_t>(opt);
-        //        debug("\nImage Addr/Size: %i:%i: %i \n", png->address(), png->size(), o);
-        //        //options:
+        debug("Flash not supported yet");
+        return nullptr;
+    }
+    bool stream = (static_cast<uint32_t>(opt)
+                   & static_cast<uint32_t>(LoadImageOpt::MediaFIFO))
+                  != 0;
+    if(stream && m_mediaFifo == nullptr)
+    {
+        debug("MediaFIFO not started\n");
+        return nullptr;
+    }
+    //CoPro overwrite top of Ram_G while decoding
+    if(stream && m_mediaFifo->address() + m_mediaFifo->size() > EVE_RAM_PNG_BUFFER)
+    {
+        debug("MediaFIFO overlaps PNG decoding buffer\n");
+        return nullptr;
+    }
 
-        //        if(width == EVE_HSIZE
-        //           && height == EVE_VSIZE
-        //           && (o & static_cast<uint32_t>(LoadImageOpt::Fullscreen)) == 0)
-        //        {
-        //            o += static_cast<uint32_t>(LoadImageOpt::Fullscreen);
-        //        }
-        //        m_parent->push(o);
-        for(uint32_t i = 0; i < png->size(); ++i)
-        {
-            m_parent->hal()->wr8(png->address() + i, *(src + i));
-        }
+    uint16_t       width{0}, height{0};
+    ImagePNGFormat fmt{ImagePNGFormat::RGB565};
+    if(!parsePNGHeader(head, headSize, width, height, fmt))
+    {
+        debug("Wrong PNG header\n");
+        return nullptr;
+    }
 
-        this->m_currentPosition += png->size();
-        m_pool.push_back(png);
-        return png;
+    auto png = new ImagePNG(name,
+                            this->m_currentPosition,
+                            width,
+                            height,
+                            fmt);
+    if(png->address() + png->size() > this->m_size)
+    {
+        error("PNG Image more than RamG free space!\n");
     }
-    else
+    //CoPro overwrite top of Ram_G while decoding
+    if(png->address() + png->size() > EVE_RAM_PNG_BUFFER)
+    {
+        error("PNG Image overlaps PNG decoding buffer!\n");
+    }
+
+    uint32_t endPtr = stream
+                          ? streamImage(png->address(), head, headSize, tail, opt)
+                          : loadImage(png->address(), head, headSize, opt);
+    debug_if(m_parent->cmdResult(8) != width
+                 || m_parent->cmdResult(4) != height,
+             "PNG decoded size differs from header\n");
+    if(endPtr == 0)
     {
-        debug("MediaFIFO and Flash not supported yet");
+        debug("PNG decoding failed\n");
+        delete png;
         return nullptr;
     }
+    //Keep next object 4 byte aligned
+    png->setSize(((endPtr - png->address()) + 3) & ~3UL);
+
+    this->m_currentPosition += png->size();
+    m_pool.push_back(png);
+    return png;
+#endif
 }
 
-void RamG::memCopy(uint32_t dest, uint32_t src, uint32_t num) const
+ImageJPEG * RamG::loadJPEG(string          name,
+                           const uint8_t * src,
+                           uint32_t        size,
+                           ImageJPEGFormat fmt,
+                           LoadImageOpt    opt) const
 {
-    if(dest + num > m_size)
+    if(m_parent->m_cmdBuffer.size() != 0)
     {
-        debug("RamG memCopy out of memory\n");
-        return;
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
     }
-    m_parent->push(CMD_MEMCPY);
-    m_parent->push(dest);
-    m_parent->push(src);
-    m_parent->push(num);
-    m_parent->execute();
+    if((static_cast<uint32_t>(opt) & static_cast<uint32_t>(LoadImageOpt::Flash)) != 0)
+    {
+        debug("Flash not supported yet");
+        return nullptr;
+    }
+    return decodeJPEG(name, src, size, nullptr, fmt, opt);
 }
 
-void RamG::memZero(uint32_t ptr, uint32_t num) const
+ImageJPEG * RamG::loadJPEG(string          name,
+                           DataProducer    producer,
+                           ImageJPEGFormat fmt,
+                           LoadImageOpt    opt) const
 {
-    if(ptr + num > m_size)
+    if(m_parent->m_cmdBuffer.size() != 0)
     {
-        debug("RamG memZero out of memory\n");
-        return;
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
     }
-    m_parent->push(CMD_MEMZERO);
-    m_parent->push(ptr);
-    m_parent->push(num);
-    m_parent->execute();
+    if((static_cast<uint32_t>(opt) & static_cast<uint32_t>(LoadImageOpt::Flash)) != 0)
+    {
+        debug("Flash not supported yet");
+        return nullptr;
+    }
+    //Collect markers up to SOF to get image size before decoding
+    uint8_t  head[JPEGHeaderSize];
+    uint32_t headSize = 0;
+    while(headSize < JPEGHeaderSize)
+    {
+        uint32_t len = producer(head + headSize, JPEGHeaderSize - headSize);
+        if(len == 0)
+            break;
+        headSize += len;
+    }
+    return decodeJPEG(name,
+                      head,
+                      headSize,
+                      producer,
+                      fmt,
+                      static_cast<LoadImageOpt>(static_cast<uint32_t>(opt)
+                                                | static_cast<uint32_t>(LoadImageOpt::MediaFIFO)));
 }
 
-void RamG::memSet(uint32_t ptr, uint8_t value, uint32_t num) const
+ImageJPEG * RamG::decodeJPEG(string          name,
+                             const uint8_t * head,
+                             uint32_t        headSize,
+                             DataProducer    tail,
+                             ImageJPEGFormat fmt,
+                             LoadImageOpt    opt) const
 {
-    if(ptr + num > m_size)
+    bool stream = (static_cast<uint32_t>(opt)
+                   & static_cast<uint32_t>(LoadImageOpt::MediaFIFO))
+                  != 0;
+    if(stream && m_mediaFifo == nullptr)
     {
-        debug("RamG memSet out of memory\n");
-        return;
+        debug("MediaFIFO not started\n");
+        return nullptr;
     }
-    m_parent->push(CMD_MEMSET);
-    m_parent->push(ptr);
-    m_parent->push(value);
-    m_parent->push(num);
-    m_parent->execute();
+
+    uint16_t width{0}, height{0};
+    if(!parseJPEGHeader(head, headSize, width, height))
+    {
+        debug(stream ? "Wrong or progressive JPEG header, or SOF is not in first %lu bytes\n"
+                     : "Wrong or progressive JPEG header\n",
+              static_cast<unsigned long>(JPEGHeaderSize));
+        return nullptr;
+    }
+    //Check free space before decoding, streamed data can not be sent again.
+    //MediaFIFO is carved above m_size, so it is not overwritten either
+    uint32_t address = this->m_currentPosition;
+    if(address + width * height * (fmt == ImageJPEGFormat::L8 ? 1u : 2u) > this->m_size)
+    {
+        error("JPEG Image more than RamG free space!\n");
+    }
+
+    //L8 JPEG decoded with OPT_MONO, RGB565 - without
+    uint32_t o = static_cast<uint32_t>(opt);
+    if(fmt == ImageJPEGFormat::L8)
+        o |= static_cast<uint32_t>(LoadImageOpt::Mono);
+    else
+        o &= ~static_cast<uint32_t>(LoadImageOpt::Mono);
+
+    uint32_t endPtr = stream
+                         ? streamImage(address, head, headSize, tail, static_cast<LoadImageOpt>(o))
+                         : loadImage(address, head, headSize, static_cast<LoadImageOpt>(o));
+    debug_if(m_parent->cmdResult(8) != width
+                 || m_parent->cmdResult(4) != height,
+             "JPEG decoded size differs from header\n");
+    if(endPtr == 0)
+    {
+        debug("JPEG decoding failed\n");
+        return nullptr;
+    }
+
+    auto jpeg = new ImageJPEG(name,
+                              address,
+                              width,
+                              height,
+                              fmt);
+    jpeg->setSize(((endPtr - address) + 3) & ~3UL);
+
+    this->m_currentPosition += jpeg->size();
+    m_pool.push_back(jpeg);
+    return jpeg;
 }
 
-void RamG::removeStoredObject(StoredObject * o) const
+CompressedImage * RamG::inflate(string           name,
+                                const uint8_t *  src,
+                                uint32_t         size,
+                                BitmapExtFormats fmt,
+                                uint16_t         width,
+                                uint16_t         height) const
 {
-    m_pool.erase(
-        std::remove(m_pool.begin(),
-                    m_pool.end(),
-                    o),
-        m_pool.end());
-    memZero(o->address(), o->size());
-    delete o;
-    alignMemory();
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    uint32_t address = this->m_currentPosition;
+    m_parent->push(CMD_INFLATE);
+    m_parent->push(address);
+    m_parent->writeData(src, size);
+    return storeInflated(name, address, fmt, width, height);
 }
 
-void RamG::removeStoredObject(string name) const
+#if defined(BT81X_ENABLE)
+CompressedImage * RamG::inflate(string           name,
+                                DataProducer     producer,
+                                BitmapExtFormats fmt,
+                                uint16_t         width,
+                                uint16_t         height) const
 {
-    for(auto it = m_pool.begin(); it != m_pool.end();)    // No ++ here
+    if(m_parent->m_cmdBuffer.size() != 0)
     {
-        if(it.operator*()->name() == name)
-        {
-            memZero(it.operator*()->address(),
-                    it.operator*()->size());
-            delete *it;
-            it = m_pool.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
     }
-    alignMemory();
+    if(m_mediaFifo == nullptr)
+    {
+        debug("MediaFIFO not started\n");
+        return nullptr;
+    }
+    uint32_t address = this->m_currentPosition;
+    m_parent->push(CMD_INFLATE2);
+    m_parent->push(address);
+    m_parent->push(EVE_OPT_MEDIAFIFO);
+    m_parent->writeStream(m_mediaFifo, producer);
+    return storeInflated(name, address, fmt, width, height);
 }
+#endif
 
-void RamG::alignMemory() const
+CompressedImage * RamG::storeInflated(string           name,
+                                      uint32_t         address,
+                                      BitmapExtFormats fmt,
+                                      uint16_t         width,
+                                      uint16_t         height) const
 {
-    if(m_pool.size() == 0)
+    //End of inflated data
+    m_parent->push(CMD_GETPTR);
+    m_parent->push(0);
+    m_parent->execute();
+
+    uint32_t endPtr = m_parent->cmdResult(4);
+    if(endPtr <= address)
     {
-        m_currentPosition = 0;
-        return;
+        debug("Inflating failed\n");
+        return nullptr;
     }
-    std::sort(m_pool.begin(), m_pool.end(), StoredObject::compareAddress);
-    uint32_t next{0}, addrIt{0};
-    for(auto it = m_pool.begin();
-        it != m_pool.end();
-        ++it)
+    if(endPtr > this->m_size)
     {
-        if(it.operator*()->address() != addrIt)
-            break;
-        addrIt += it.operator*()->size();
-        ++next;
+        error("Inflated data more than RamG free space!\n");
+    }
+
+    auto image = new CompressedImage(name,
+                                     address,
+                                     width,
+                                     height,
+                                     fmt);
+    //Keep next object 4 byte aligned
+    image->setSize(((endPtr - address) + 3) & ~3UL);
+
+    this->m_currentPosition += image->size();
+    m_pool.push_back(image);
+    return image;
+}
+
+Atlas * RamG::loadAtlas(string           name,
+                        const uint8_t *  data,
+                        uint32_t         size,
+                        BitmapExtFormats fmt,
+                        uint16_t         cellWidth,
+                        uint16_t         cellHeight,
+                        uint32_t         crc) const
+{
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    auto atlas = new Atlas(name,
+                           this->m_currentPosition,
+                           (size + 3) & ~3UL,
+                           fmt,
+                           cellWidth,
+                           cellHeight);
+    if(atlas->address() + atlas->size() > this->m_size)
+    {
+        error("Atlas more than RamG free space!\n");
+    }
+    memWrite(atlas->address(), data, size, crc);
+
+    this->m_currentPosition += atlas->size();
+    m_pool.push_back(atlas);
+    return atlas;
+}
+
+#if defined(BT81X_ENABLE)
+Atlas * RamG::loadAtlas(string             name,
+                        const FlashAsset & asset,
+                        uint16_t           cellWidth,
+                        uint16_t           cellHeight) const
+{
+    if(asset.type != FlashAssetType::Bitmap && asset.type != FlashAssetType::Deflate)
+    {
+        debug("Flash asset is not bitmap\n");
+        return nullptr;
+    }
+    //Load as plain bitmap and take its place in pool
+    auto bitmap = loadFromFlash(name, asset);
+    if(bitmap == nullptr)
+        return nullptr;
+    auto atlas = new Atlas(name,
+                           bitmap->address(),
+                           bitmap->size(),
+                           static_cast<BitmapExtFormats>(asset.format),
+                           cellWidth,
+                           cellHeight);
+    std::replace(m_pool.begin(), m_pool.end(), bitmap, static_cast<StoredObject *>(atlas));
+    delete bitmap;
+    return atlas;
+}
+#endif
+
+Palette * RamG::loadPalette(string           name,
+                            const uint8_t *  lut,
+                            uint32_t         size,
+                            BitmapExtFormats fmt,
+                            uint32_t         crc) const
+{
+    if(fmt != BitmapExtFormats::PALETTED565
+       && fmt != BitmapExtFormats::PALETTED4444
+       && fmt != BitmapExtFormats::PALETTED8)
+    {
+        debug("Palette format must be PALETTED565, PALETTED4444 or PALETTED8\n");
+        return nullptr;
+    }
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    auto palette = new Palette(name,
+                               this->m_currentPosition,
+                               (size + 3) & ~3UL,
+                               fmt);
+    if(palette->address() + palette->size() > this->m_size)
+    {
+        error("Palette more than RamG free space!\n");
+    }
+    memWrite(palette->address(), lut, size, crc);
+
+    this->m_currentPosition += palette->size();
+    m_pool.push_back(palette);
+    return palette;
+}
+
+PalettedBitmap * RamG::loadPaletted(string          name,
+                                    const uint8_t * indices,
+                                    uint16_t        width,
+                                    uint16_t        height,
+                                    const Palette * palette,
+                                    uint32_t        crc) const
+{
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    auto bitmap = new PalettedBitmap(name,
+                                     this->m_currentPosition,
+                                     width,
+                                     height,
+                                     palette);
+    if(bitmap->address() + bitmap->size() > this->m_size)
+    {
+        error("Paletted bitmap more than RamG free space!\n");
+    }
+    memWrite(bitmap->address(), indices, bitmap->size(), crc);
+    //Keep next object 4 byte aligned
+    bitmap->setSize((bitmap->size() + 3) & ~3UL);
+
+    this->m_currentPosition += bitmap->size();
+    m_pool.push_back(bitmap);
+    return bitmap;
+}
+
+#if defined(BT81X_ENABLE)
+Palette * RamG::loadPalette(string name, const FlashAsset & asset) const
+{
+    //Load as plain data and take its place in pool
+    auto raw = loadFromFlash(name, asset);
+    if(raw == nullptr)
+        return nullptr;
+    auto palette = new Palette(name,
+                               raw->address(),
+                               raw->size(),
+                               static_cast<BitmapExtFormats>(asset.format));
+    std::replace(m_pool.begin(), m_pool.end(), raw, static_cast<StoredObject *>(palette));
+    delete raw;
+    return palette;
+}
+
+PalettedBitmap * RamG::loadPaletted(string             name,
+                                    const FlashAsset & asset,
+                                    const Palette *    palette) const
+{
+    auto raw = loadFromFlash(name, asset);
+    if(raw == nullptr)
+        return nullptr;
+    auto bitmap = new PalettedBitmap(name,
+                                     raw->address(),
+                                     asset.width,
+                                     asset.height,
+                                     palette);
+    bitmap->setSize(raw->size());
+    std::replace(m_pool.begin(), m_pool.end(), raw, static_cast<StoredObject *>(bitmap));
+    delete raw;
+    return bitmap;
+}
+#endif
+
+Font * RamG::loadFont(string          name,
+                      uint8_t         handle,
+                      const uint8_t * data,
+                      uint32_t        size,
+                      uint8_t         firstChar,
+                      uint32_t        crc) const
+{
+    //Metric block: 128 widths, format, stride, width, height, glyph pointer
+    if(size < 148)
+    {
+        debug("Font data is less than metric block\n");
+        return nullptr;
+    }
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    uint16_t height = static_cast<uint16_t>(data[140] | (data[141] << 8));
+    auto     font   = new Font(name,
+                         this->m_currentPosition,
+                         (size + 3) & ~3UL,
+                         handle,
+                         firstChar,
+                         height);
+    if(font->address() + font->size() > this->m_size)
+    {
+        error("Font more than RamG free space!\n");
+    }
+    //Metric block goes with glyph pointer already set, so upload check compares it with Ram_G content
+    uint8_t metrics[148];
+    memcpy(metrics, data, 144);
+    uint32_t gptr = font->address() + 148;
+    memcpy(metrics + 144, &gptr, 4);
+    memWrite(font->address(), metrics, 148);
+    if(size > 148)
+        memWrite(font->address() + 148, data + 148, size - 148, crc);
+    font->m_width = static_cast<uint16_t>(data[136] | (data[137] << 8));
+    font->m_widths.emplace_back(data, data + 128);
+    linkFont(font);
+
+    this->m_currentPosition += font->size();
+    m_pool.push_back(font);
+    return font;
+}
+
+#if defined(BT81X_ENABLE)
+Font * RamG::loadFont(string             name,
+                      uint8_t            handle,
+                      const FlashAsset & header,
+                      const FlashAsset & glyphs,
+                      uint8_t            residentPages) const
+{
+    const Flash * flash = m_parent->m_flash;
+    if(flash == nullptr)
+    {
+        debug("Flash not initialized\n");
+        return nullptr;
+    }
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+    uint32_t address    = this->m_currentPosition;
+    uint32_t headerSize = (header.size + 3) & ~3UL;
+    if(address + headerSize > this->m_size)
+    {
+        error("Font more than RamG free space!\n");
+    }
+    if(!flash->read(address, header.address, headerSize))
+        return nullptr;
+    auto hal = m_parent->m_hal;
+    if(hal->rd32(address) != Font::XFontSignature)
+    {
+        debug("Flash asset is not extended font\n");
+        return nullptr;
+    }
+    auto     format    = static_cast<BitmapExtFormats>(hal->rd32(address + Font::XFontFormat));
+    uint32_t glyphSize = bitmapByteSize(format,
+                                        hal->rd32(address + Font::XFontLayoutWidth),
+                                        hal->rd32(address + Font::XFontLayoutHeight));
+
+    auto font = new Font(name,
+                         address,
+                         headerSize,
+                         handle,
+                         0,
+                         hal->rd32(address + Font::XFontPixelHeight),
+                         true);
+    font->m_width         = hal->rd32(address + Font::XFontPixelWidth);
+    font->m_pageCount     = (hal->rd32(address + Font::XFontChars) + 127) / 128;
+    font->m_headerSize    = headerSize;
+    font->m_glyphSource   = glyphs.address;
+    font->m_glyphPageSize = glyphSize * 128;
+    font->m_widths.resize(font->m_pageCount);
+    //ASTC is drawn from flash, other formats need pages in Ram_G. Slot has room for flash read alignment
+    if(!isASTC(format))
+    {
+        font->m_slotSize = (font->m_glyphPageSize + 63 + 3) & ~3UL;
+        font->m_slots.resize(residentPages == 0 ? 1 : residentPages);
+        font->setSize(headerSize + font->m_slotSize * font->m_slots.size());
+        if(address + font->size() > this->m_size)
+        {
+            error("Font glyph pages more than RamG free space!\n");
+        }
+    }
+    //Header is generated for address 0
+    font->m_linkedAddress = 0;
+    linkFont(font);
+
+    this->m_currentPosition += font->size();
+    m_pool.push_back(font);
+    return font;
+}
+#endif
+
+bool RamG::requireGlyphs(const Font * font, const std::string & text) const
+{
+    if(font->paged() == false)
+        return true;
+    bool   result = true;
+    size_t pos    = 0;
+    while(pos < text.size())
+    {
+        uint32_t page = Font::nextChar(text, pos) / 128;
+        if(page < font->m_pageCount)
+            result = loadGlyphPage(font, page, m_parent->m_frame) && result;
+    }
+    return result;
+}
+
+uint8_t RamG::glyphWidth(const Font * font, uint32_t code) const
+{
+    if(font->extended() == false)
+        return code < 128 ? font->m_widths.front()[code] : 0;
+
+    uint32_t page = code / 128;
+    if(page >= font->m_pageCount)
+        return 0;
+    auto & widths = font->m_widths[page];
+    if(widths.empty())
+    {
+        widths.resize(128);
+        uint32_t wptr = font->address() + Font::XFontGptr + 4 * (font->m_pageCount + page);
+        m_parent->m_hal->rdByteBuffer(m_parent->m_hal->rd32(wptr), widths.data(), 128);
+    }
+    return widths[code % 128];
+}
+
+void RamG::linkFont(Font * f) const
+{
+    auto hal = m_parent->m_hal;
+    if(f->extended() == false)
+    {
+        //Glyphs are just after metric block
+        hal->wr32(f->address() + 144, f->address() + 148);
+        f->m_linkedAddress = f->address();
+        return;
+    }
+    uint32_t gptr = f->address() + Font::XFontGptr;
+    uint32_t wptr = gptr + 4 * f->m_pageCount;
+    for(uint16_t page = 0; page < f->m_pageCount; ++page)
+    {
+        hal->wr32(wptr + 4 * page,
+                  hal->rd32(wptr + 4 * page) - f->m_linkedAddress + f->address());
+        hal->wr32(gptr + 4 * page, glyphPointer(f, page));
+    }
+    f->m_linkedAddress = f->address();
+}
+
+uint32_t RamG::glyphPointer(const Font * f, uint16_t page) const
+{
+    uint32_t src = f->m_glyphSource + page * f->m_glyphPageSize;
+#if defined(BT81X_ENABLE)
+    if(f->paged() == false)
+        return flashSource(src);
+#endif
+    uint32_t slots = f->address() + f->m_headerSize;
+    for(size_t i = 0; i < f->m_slots.size(); ++i)
+    {
+        if(f->m_slots[i].page == page)
+            return slots + i * f->m_slotSize + (src & 63);
+    }
+    //Not resident page points to first slot until it is required
+    return slots;
+}
+
+bool RamG::loadGlyphPage(const Font * f, uint16_t page, uint32_t frame) const
+{
+    Font::GlyphSlot * victim = nullptr;
+    for(auto & slot : f->m_slots)
+    {
+        if(slot.page == page)
+        {
+            slot.lastUse = frame;
+            return true;
+        }
+        //Pages of current and displayed frames are kept
+        if(slot.page != Font::NoPage && slot.lastUse + 1 >= frame)
+            continue;
+        if(victim == nullptr || slot.page == Font::NoPage || slot.lastUse < victim->lastUse)
+            victim = &slot;
+    }
+    if(victim == nullptr)
+    {
+        debug("No free glyph page for font %s\n", f->name().c_str());
+        return false;
+    }
+#if defined(BT81X_ENABLE)
+    const Flash * flash = m_parent->m_flash;
+    uint32_t      src   = f->m_glyphSource + page * f->m_glyphPageSize;
+    uint32_t      slot  = f->address() + f->m_headerSize + (victim - f->m_slots.data()) * f->m_slotSize;
+    if(flash == nullptr
+       || !flash->read(slot,
+                       src & ~63UL,
+                       ((src & 63) + f->m_glyphPageSize + 3) & ~3UL))
+        return false;
+#endif
+    victim->page    = page;
+    victim->lastUse = frame;
+    m_parent->m_hal->wr32(f->address() + Font::XFontGptr + 4 * page,
+                          glyphPointer(f, page));
+    return true;
+}
+
+#if defined(BT81X_ENABLE)
+StoredObject * RamG::loadFromFlash(string name, const FlashAsset & asset) const
+{
+    const Flash * flash = m_parent->m_flash;
+    if(flash == nullptr)
+    {
+        debug("Flash not initialized\n");
+        return nullptr;
+    }
+    if(m_parent->m_cmdBuffer.size() != 0)
+    {
+        m_parent->m_hal->wr16(REG_CMD_DL, 0);
+        m_parent->execute();
+    }
+
+    uint32_t address = this->m_currentPosition;
+    switch(asset.type)
+    {
+    case FlashAssetType::Raw:
+    case FlashAssetType::Bitmap:
+    {
+        uint32_t size = (asset.size + 3) & ~3UL;
+        if(address + size > this->m_size)
+        {
+            error("Flash asset more than RamG free space!\n");
+        }
+        if(!flash->read(address, asset.address, size))
+            return nullptr;
+        auto bitmap = new RawBitmap(name,
+                                    address,
+                                    size,
+                                    asset.width,
+                                    asset.height,
+                                    static_cast<BitmapExtFormats>(asset.format));
+        this->m_currentPosition += bitmap->size();
+        m_pool.push_back(bitmap);
+        return bitmap;
+    }
+    case FlashAssetType::Deflate:
+        //CoPro doesn't stop at end of Ram_G, check inflated size before
+        if(address + bitmapByteSize(static_cast<BitmapExtFormats>(asset.format),
+                                    asset.width,
+                                    asset.height)
+           > this->m_size)
+        {
+            error("Flash asset more than RamG free space!\n");
+        }
+        flash->source(asset.address);
+        m_parent->push(CMD_INFLATE2);
+        m_parent->push(address);
+        m_parent->push(EVE_OPT_FLASH);
+        return storeInflated(name,
+                             address,
+                             static_cast<BitmapExtFormats>(asset.format),
+                             asset.width,
+                             asset.height);
+    case FlashAssetType::ImagePNG:
+    case FlashAssetType::ImageJPEG:
+    {
+        StoredObject * image;
+        if(asset.type == FlashAssetType::ImagePNG)
+            image = new ImagePNG(name,
+                                 address,
+                                 asset.width,
+                                 asset.height,
+                                 static_cast<ImagePNGFormat>(asset.format));
+        else
+            image = new ImageJPEG(name,
+                                  address,
+                                  asset.width,
+                                  asset.height,
+                                  static_cast<ImageJPEGFormat>(asset.format));
+        //Size from directory, checked before CoPro writes anything
+        if(image->address() + image->size() > this->m_size)
+        {
+            error("Flash image more than RamG free space!\n");
+        }
+#if defined(EVE_RAM_PNG_BUFFER)
+        //CoPro overwrite top of Ram_G while decoding
+        if(asset.type == FlashAssetType::ImagePNG
+           && image->address() + image->size() > EVE_RAM_PNG_BUFFER)
+        {
+            error("PNG Image overlaps PNG decoding buffer!\n");
+        }
+#endif
+        flash->source(asset.address);
+        m_parent->push(CMD_LOADIMAGE);
+        m_parent->push(address);
+        m_parent->push(static_cast<uint32_t>(LoadImageOpt::NoDL)
+                       | static_cast<uint32_t>(LoadImageOpt::Flash)
+                       | (asset.format == static_cast<uint16_t>(ImageJPEGFormat::L8)
+                                  && asset.type == FlashAssetType::ImageJPEG
+                              ? static_cast<uint32_t>(LoadImageOpt::Mono)
+                              : 0));
+        m_parent->push(CMD_GETPROPS);
+        m_parent->push(0);    //ptr
+        m_parent->push(0);    //width
+        m_parent->push(0);    //height
+        m_parent->execute();
+
+        uint32_t endPtr = m_parent->cmdResult(12);
+        if(endPtr <= address)
+        {
+            debug("Flash image decoding failed\n");
+            delete image;
+            return nullptr;
+        }
+        debug_if(endPtr > image->address() + image->size(),
+                 "Flash image decoded size differs from directory\n");
+        image->setSize(((endPtr - address) + 3) & ~3UL);
+        this->m_currentPosition += image->size();
+        m_pool.push_back(image);
+        return image;
+    }
+    }
+    return nullptr;
+}
+#endif
+
+uint32_t RamG::loadImage(uint32_t        address,
+                         const uint8_t * src,
+                         uint32_t        size,
+                         LoadImageOpt    opt) const
+{
+    m_parent->push(CMD_LOADIMAGE);
+    m_parent->push(address);
+    m_parent->push(static_cast<uint32_t>(opt));
+    m_parent->writeData(src, size);
+
+    //Get real end of decoded image
+    m_parent->push(CMD_GETPROPS);
+    m_parent->push(0);    //ptr
+    m_parent->push(0);    //width
+    m_parent->push(0);    //height
+    m_parent->execute();
+
+    uint32_t endPtr = m_parent->cmdResult(12);
+    if(endPtr <= address)
+        return 0;
+    return endPtr;
+}
+
+uint32_t RamG::streamImage(uint32_t        address,
+                           const uint8_t * head,
+                           uint32_t        headSize,
+                           DataProducer    tail,
+                           LoadImageOpt    opt) const
+{
+    ChunkSource source(head, headSize, tail);
+
+    m_parent->push(CMD_LOADIMAGE);
+    m_parent->push(address);
+    m_parent->push(static_cast<uint32_t>(opt));
+    m_parent->writeStream(m_mediaFifo, mbed::callback(&source, &ChunkSource::read));
+
+    m_parent->push(CMD_GETPROPS);
+    m_parent->push(0);    //ptr
+    m_parent->push(0);    //width
+    m_parent->push(0);    //height
+    m_parent->execute();
+
+    uint32_t endPtr = m_parent->cmdResult(12);
+    if(endPtr <= address)
+        return 0;
+    return endPtr;
+}
+
+MediaFifo * RamG::startMediaFifo(uint32_t size)
+{
+    if(m_mediaFifo != nullptr)
+        return m_mediaFifo;
+    size &= ~3UL;
+    if(size == 0 || this->m_currentPosition + size > this->m_size)
+    {
+        debug("No RamG free space for MediaFIFO\n");
+        return nullptr;
+    }
+    //FIFO is carved from the top of allocated Ram_G
+    this->m_size -= size;
+    m_mediaFifo = new MediaFifo(m_parent, this->m_size, size);
+    return m_mediaFifo;
+}
+
+void RamG::stopMediaFifo()
+{
+    if(m_mediaFifo == nullptr)
+        return;
+    this->m_size += m_mediaFifo->size();
+    delete m_mediaFifo;
+    m_mediaFifo = nullptr;
+}
+
+MediaFifo * RamG::mediaFifo() const
+{
+    return m_mediaFifo;
+}
+
+bool RamG::parsePNGHeader(const uint8_t *  src,
+                          uint32_t         size,
+                          uint16_t &       width,
+                          uint16_t &       height,
+                          ImagePNGFormat & fmt)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    //Signature + IHDR chunk
+    if(size < 33 || memcmp(src, signature, 8) != 0 || memcmp(src + 12, "IHDR", 4) != 0)
+        return false;
+
+    auto be32 = [src](uint32_t i) -> uint32_t {
+        return (src[i] << 24) | (src[i + 1] << 16) | (src[i + 2] << 8) | src[i + 3];
+    };
+    width  = static_cast<uint16_t>(be32(16));
+    height = static_cast<uint16_t>(be32(20));
+
+    switch(src[25])    //Colour type
+    {
+    case 0:    //Grayscale
+        fmt = ImagePNGFormat::L8;
+        break;
+    case 2:    //Truecolour
+        fmt = ImagePNGFormat::RGB565;
+        break;
+    case 4:    //Grayscale with alpha
+    case 6:    //Truecolour with alpha
+        fmt = ImagePNGFormat::ARGB4;
+        break;
+    case 3:    //Indexed. PALETTED4444 if transparency chunk present
+    {
+        fmt = ImagePNGFormat::PALETTED565;
+        for(uint32_t i = 8; i + 8 <= size;)
+        {
+            if(memcmp(src + i + 4, "tRNS", 4) == 0)
+            {
+                fmt = ImagePNGFormat::PALETTED4444;
+                break;
+            }
+            if(memcmp(src + i + 4, "IDAT", 4) == 0)
+                break;
+            //length + type + data + crc. Truncated or malformed chunk stops the scan
+            uint32_t length = be32(i);
+            if(size - i < 12 || length > size - i - 12)
+                break;
+            i += length + 12;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+bool RamG::parseJPEGHeader(const uint8_t * src,
+                           uint32_t        size,
+                           uint16_t &      width,
+                           uint16_t &      height)
+{
+    //SOI marker
+    if(size < 4 || src[0] != 0xFF || src[1] != 0xD8)
+        return false;
+
+    for(uint32_t i = 2; i + 9 < size;)
+    {
+        if(src[i] != 0xFF)
+            return false;
+        uint8_t marker = src[i + 1];
+        //Baseline and extended sequential DCT. Progressive (0xC2) is not supported by CoPro
+        if(marker == 0xC0 || marker == 0xC1)
+        {
+            height = static_cast<uint16_t>((src[i + 5] << 8) | src[i + 6]);
+            width  = static_cast<uint16_t>((src[i + 7] << 8) | src[i + 8]);
+            return true;
+        }
+        if(marker == 0xC2 || marker == 0xDA)
+            return false;
+        //marker + segment length
+        i += ((src[i + 2] << 8) | src[i + 3]) + 2;
+    }
+    return false;
+}
+
+void RamG::memCopy(uint32_t dest, uint32_t src, uint32_t num) const
+{
+    if(dest + num > m_size)
+    {
+        debug("RamG memCopy out of memory\n");
+        return;
+    }
+    m_parent->push(CMD_MEMCPY);
+    m_parent->push(dest);
+    m_parent->push(src);
+    m_parent->push(num);
+    m_parent->execute();
+}
+
+void RamG::memZero(uint32_t ptr, uint32_t num) const
+{
+    if(ptr + num > m_size)
+    {
+        debug("RamG memZero out of memory\n");
+        return;
+    }
+    m_parent->push(CMD_MEMZERO);
+    m_parent->push(ptr);
+    m_parent->push(num);
+    m_parent->execute();
+}
+
+void RamG::memSet(uint32_t ptr, uint8_t value, uint32_t num) const
+{
+    if(ptr + num > m_size)
+    {
+        debug("RamG memSet out of memory\n");
+        return;
+    }
+    m_parent->push(CMD_MEMSET);
+    m_parent->push(ptr);
+    m_parent->push(value);
+    m_parent->push(num);
+    m_parent->execute();
+}
+
+void RamG::removeStoredObject(StoredObject * o) const
+{
+    //Still used by other owners
+    if(o->release() != 0)
+        return;
+    releasePalette(o);
+    m_pool.erase(
+        std::remove(m_pool.begin(),
+                    m_pool.end(),
+                    o),
+        m_pool.end());
+    //With Skip check content is kept: the same data loaded here again is found by CRC and not sent
+    if(!keepContent())
+        memZero(o->address(), o->size());
+    delete o;
+    alignMemory();
+}
+
+void RamG::removeStoredObject(string name) const
+{
+    bool found = false;
+    for(auto it = m_pool.begin(); it != m_pool.end();)    // No ++ here
+    {
+        if(it.operator*()->name() != name)
+        {
+            ++it;
+            continue;
+        }
+        found = true;
+        if(it.operator*()->release() == 0)
+        {
+            releasePalette(*it);
+            if(!keepContent())
+                memZero(it.operator*()->address(),
+                        it.operator*()->size());
+            delete *it;
+            it = m_pool.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    //Shared object keeps name of its first owner, other owners can't find it by their names
+    debug_if(!found && m_deduplicate,
+             "RamG: no object \"%s\", remove deduplicated objects by pointer\n",
+             name.c_str());
+    alignMemory();
+}
+
+void RamG::releasePalette(const StoredObject * o) const
+{
+    if(o->type() != StoredObjectType::Palette)
+        return;
+    for(auto obj : m_pool)
+    {
+        if(obj->type() == StoredObjectType::PalettedBitmap)
+        {
+            auto bitmap = static_cast<PalettedBitmap *>(obj);
+            if(bitmap->palette() == o)
+                bitmap->setPalette(nullptr);
+        }
+    }
+}
+
+void RamG::memWrite(uint32_t ptr, const uint8_t * data, uint32_t num, uint32_t crc) const
+{
+    if(ptr + num > m_size)
+    {
+        debug("RamG memWrite out of memory\n");
+        return;
+    }
+    auto check = static_cast<uint8_t>(m_uploadCheck);
+    if(check != 0 && crc == 0)
+        crc = crc32(data, num);
+    //The same data is already here
+    if((check & static_cast<uint8_t>(UploadCheck::Skip)) != 0
+       && memCrc(ptr, num) == crc)
+        return;
+
+    m_parent->push(CMD_MEMWRITE);
+    m_parent->push(ptr);
+    m_parent->push(num);
+    m_parent->writeData(data, num);
+
+    debug_if((check & static_cast<uint8_t>(UploadCheck::Verify)) != 0
+                 && memCrc(ptr, num) != crc,
+             "RamG upload CRC mismatch at %#x\n",
+             ptr);
+}
+
+uint32_t RamG::memCrc(uint32_t ptr, uint32_t num) const
+{
+    m_parent->push(CMD_MEMCRC);
+    m_parent->push(ptr);
+    m_parent->push(num);
+    m_parent->push(0);    //result
+    m_parent->execute();
+    return m_parent->cmdResult(4);
+}
+
+uint32_t RamG::crc32(const uint8_t * data, uint32_t size, uint32_t crc)
+{
+    //Nibble table of reflected 0x04C11DB7 polynomial. Small enough for MCU flash
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    crc = ~crc;
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+StoredObject * RamG::findDuplicate(const StoredObject * o) const
+{
+    if(o->hash() == 0)
+        return nullptr;
+    for(auto obj : m_pool)
+    {
+        if(obj->type() != o->type()
+           || obj->size() != o->size()
+           || obj->hash() != o->hash())
+            continue;
+        if(o->type() == StoredObjectType::Snapshot)
+        {
+            auto a = static_cast<const Snapshot *>(o);
+            auto b = static_cast<const Snapshot *>(obj);
+            //Snapshot is drawn at its captured position, so the same pixels elsewhere are not shared
+            if(a->format() != b->format()
+               || a->x() != b->x()
+               || a->y() != b->y()
+               || a->width() != b->width()
+               || a->height() != b->height()
+               || a->scale() != b->scale())
+                continue;
+        }
+        return obj;
+    }
+    return nullptr;
+}
+
+void RamG::setDeduplicate(bool enable)
+{
+    m_deduplicate = enable;
+}
+
+bool RamG::deduplicate() const
+{
+    return m_deduplicate;
+}
+
+void RamG::setUploadCheck(UploadCheck check)
+{
+    m_uploadCheck = check;
+}
+
+RamG::UploadCheck RamG::uploadCheck() const
+{
+    return m_uploadCheck;
+}
+
+bool RamG::keepContent() const
+{
+    return (static_cast<uint8_t>(m_uploadCheck) & static_cast<uint8_t>(UploadCheck::Skip)) != 0;
+}
+
+void RamG::alignMemory() const
+{
+    if(m_pool.size() == 0)
+    {
+        m_currentPosition = 0;
+        return;
+    }
+    std::sort(m_pool.begin(), m_pool.end(), StoredObject::compareAddress);
+    uint32_t next{0}, addrIt{0};
+    for(auto it = m_pool.begin();
+        it != m_pool.end();
+        ++it)
+    {
+        if(it.operator*()->address() != addrIt)
+            break;
+        addrIt += it.operator*()->size();
+        ++next;
     }
 
     if(m_pool.size() == next)
     {
         m_currentPosition = m_pool.back()->address()
                             + m_pool.back()->size();
+        //Fonts keep absolute pointers inside
+        for(auto obj : m_pool)
+        {
+            if(obj->type() == StoredObjectType::Font
+               && static_cast<Font *>(obj)->m_linkedAddress != obj->address())
+                linkFont(static_cast<Font *>(obj));
+        }
         return;
     }
 
@@ -359,32 +1709,109 @@ void RamG::alignMemory() const
 
     while(addrIt < m_currentPosition)
     {
-        if(addrIt + gap > m_currentPosition)
+        if(addrIt + gap > m_currentPosition)
+        {
+            uint32_t lastgap = gap - (m_currentPosition - addrIt);
+            memZero(addrIt, lastgap);
+            memCopy(addrIt, nextAddress, lastgap);
+            break;
+        }
+        memZero(addrIt, gap);
+        memCopy(addrIt, nextAddress, gap);
+        addrIt += gap;
+        nextAddress += gap;
+    }
+    m_currentPosition -= gap;
+    alignMemory();
+}
+
+const std::vector<StoredObject *> & RamG::pool() const
+{
+    return m_pool;
+}
+
+uint32_t RamG::freeSpace() const
+{
+    return m_size - m_currentPosition;
+}
+MediaFifo::MediaFifo(FT8xx * parent, uint32_t address, uint32_t size) :
+    m_parent(parent),
+    m_address(address),
+    m_size(size)
+{
+    m_parent->push(CMD_MEDIAFIFO);
+    m_parent->push(m_address);
+    m_parent->push(m_size);
+    m_parent->execute();
+    //CMD_MEDIAFIFO reset FIFO pointers
+    m_write = m_parent->m_hal->rd32(REG_MEDIAFIFO_WRITE);
+}
+
+uint32_t MediaFifo::address() const
+{
+    return m_address;
+}
+
+uint32_t MediaFifo::size() const
+{
+    return m_size;
+}
+
+uint32_t MediaFifo::freeSpace() const
+{
+    uint32_t read = m_parent->m_hal->rd32(REG_MEDIAFIFO_READ);
+    //One word always kept free to distinguish full FIFO from empty
+    return (read + m_size - m_write - 4) % m_size;
+}
+
+uint32_t MediaFifo::write(const uint8_t * data, uint32_t size)
+{
+    uint32_t space = freeSpace();
+    //Only whole words can be written while data is not fit
+    uint32_t len = size <= space ? size : space & ~3UL;
+    if(len == 0)
+        return 0;
+
+    uint32_t written = 0;
+    while(written < len)
+    {
+        //Split on ring buffer end and on HAL burst size
+        uint32_t chunk = std::min(len - written, m_size - m_write);
+        chunk          = std::min(chunk, static_cast<uint32_t>(ChunkSize));
+        m_parent->m_hal->wrByteBuffer(m_address + m_write,
+                                      data + written,
+                                      static_cast<uint16_t>(chunk));
+        written += chunk;
+        m_write = (m_write + ((chunk + 3) & ~3UL)) % m_size;
+    }
+    m_parent->m_hal->wr32(REG_MEDIAFIFO_WRITE, m_write);
+    return len;
+}
+
+bool MediaFifo::writeAll(const uint8_t * data, uint32_t size)
+{
+    uint32_t written = 0;
+    while(written < size)
+    {
+        uint32_t len = write(data + written, size - written);
+        if(len == 0)
         {
-            uint32_t lastgap = gap - (m_currentPosition - addrIt);
-            memZero(addrIt, lastgap);
-            memCopy(addrIt, nextAddress, lastgap);
-            break;
+            //CoPro fault, nobody reads FIFO anymore
+            if(m_parent->m_hal->rd16(REG_CMD_READ) == 0xFFF)
+                return false;
+            ThisThread::sleep_for(1);
         }
-        memZero(addrIt, gap);
-        memCopy(addrIt, nextAddress, gap);
-        addrIt += gap;
-        nextAddress += gap;
+        written += len;
     }
-    m_currentPosition -= gap;
-    alignMemory();
+    return true;
 }
 
-const std::vector<StoredObject *> & RamG::pool() const
-{
-    return m_pool;
-}
 #if defined(BT81X_ENABLE)
 Flash::Flash(FT8xx * parent, uint32_t size) :
     m_parent(parent),
     m_size(size)
 {
-    uint8_t t;
+    uint8_t t{0};
     //    m_flashStatus = static_cast<FlashStatus>(m_parent->m_hal->rd8(REG_FLASH_STATUS));
 
     while((m_flashStatus = static_cast<FlashStatus>(m_parent->m_hal->rd8(REG_FLASH_STATUS)))
@@ -395,7 +1822,6 @@ Flash::Flash(FT8xx * parent, uint32_t size) :
         if(t > 100)
         {
             debug("Flash attach error\n");
-            delete this;
             return;
         }
     }
@@ -432,10 +1858,282 @@ Flash::Flash(FT8xx * parent, uint32_t size) :
     debug("Flash Init Failed\n");
 }
 
+Flash::~Flash()
+{
+    for(auto b : m_bitmaps)
+        delete b;
+    for(auto a : m_atlases)
+        delete a;
+}
+
 FlashStatus Flash::flashStatus() const
 {
     return m_flashStatus;
 }
+
+uint32_t Flash::size() const
+{
+    return m_size;
+}
+
+bool Flash::read(uint32_t dest, uint32_t src, uint32_t num) const
+{
+    if(!checkFull())
+        return false;
+    if((dest & 3) != 0 || (src & 63) != 0 || (num & 3) != 0)
+    {
+        debug("Flash read wrong alignment\n");
+        return false;
+    }
+    m_parent->push(CMD_FLASHREAD);
+    m_parent->push(dest);
+    m_parent->push(src);
+    m_parent->push(num);
+    return m_parent->execute();
+}
+
+bool Flash::write(uint32_t dest, const uint8_t * data, uint32_t num) const
+{
+    if(!checkFull())
+        return false;
+    if((dest & 255) != 0 || (num & 255) != 0)
+    {
+        debug("Flash write wrong alignment\n");
+        return false;
+    }
+    m_parent->push(CMD_FLASHWRITE);
+    m_parent->push(dest);
+    m_parent->push(num);
+    return m_parent->writeData(data, num);
+}
+
+bool Flash::update(uint32_t dest, uint32_t src, uint32_t num) const
+{
+    if(!checkFull())
+        return false;
+    if((dest & (FlashSectorSize - 1)) != 0 || (src & 3) != 0 || (num & (FlashSectorSize - 1)) != 0)
+    {
+        debug("Flash update wrong alignment\n");
+        return false;
+    }
+    m_parent->push(CMD_FLASHUPDATE);
+    m_parent->push(dest);
+    m_parent->push(src);
+    m_parent->push(num);
+    //Each changed sector is erased and written
+    return m_parent->execute(1000 + (num / FlashSectorSize) * 100);
+}
+
+bool Flash::update(uint32_t dest, const uint8_t * data, uint32_t num) const
+{
+    if((dest & (FlashSectorSize - 1)) != 0)
+    {
+        debug("Flash update wrong alignment\n");
+        return false;
+    }
+    for(uint32_t offset = 0; offset < num; offset += FlashSectorSize)
+    {
+        uint32_t len = std::min(FlashSectorSize, num - offset);
+        //Keep old content of partial sector
+        if(len < FlashSectorSize && !read(ScratchAddress, dest + offset, FlashSectorSize))
+            return false;
+        uint32_t aligned = len & ~3UL;
+        m_parent->m_hal->wrByteBuffer(ScratchAddress,
+                                      data + offset,
+                                      static_cast<uint16_t>(aligned));
+        for(uint32_t i = aligned; i < len; ++i)
+            m_parent->m_hal->wr8(ScratchAddress + i, data[offset + i]);
+        if(!update(dest + offset, ScratchAddress, FlashSectorSize))
+            return false;
+    }
+    return true;
+}
+
+bool Flash::erase() const
+{
+    if(!checkFull())
+        return false;
+    m_parent->push(CMD_FLASHERASE);
+    //Chip erase takes seconds
+    bool done = m_parent->execute(m_size / FlashSectorSize * 50 + 1000);
+    m_assets.clear();
+    return done;
+}
+
+void Flash::source(uint32_t src) const
+{
+    m_parent->push(CMD_FLASHSOURCE);
+    m_parent->push(src);
+}
+
+uint32_t Flash::loadDirectory(uint32_t address) const
+{
+    m_assets.clear();
+    if(m_flashStatus != FLASH_STATUS_FULL)
+        return 0;
+    if(!read(ScratchAddress, address, FlashAssetHeaderSize))
+        return 0;
+    if(m_parent->m_hal->rd32(ScratchAddress) != FlashAssetMagic)
+    {
+        debug("No asset directory in flash\n");
+        return 0;
+    }
+    uint32_t count = m_parent->m_hal->rd32(ScratchAddress + 4);
+    uint32_t total = FlashAssetHeaderSize + count * FlashAssetEntrySize;
+    if(total > ScratchSize)
+    {
+        debug("Flash asset directory too big\n");
+        return 0;
+    }
+    //Whole directory in one CMD_FLASHREAD
+    if(!read(ScratchAddress, address, (total + 3) & ~3UL))
+        return 0;
+
+    m_assets.reserve(count);
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t   entry = ScratchAddress + FlashAssetHeaderSize + i * FlashAssetEntrySize;
+        FlashAsset asset;
+        asset.id      = m_parent->m_hal->rd32(entry);
+        asset.address = m_parent->m_hal->rd32(entry + 4);
+        asset.size    = m_parent->m_hal->rd32(entry + 8);
+        asset.type    = static_cast<FlashAssetType>(m_parent->m_hal->rd16(entry + 12));
+        asset.format  = m_parent->m_hal->rd16(entry + 14);
+        asset.width   = m_parent->m_hal->rd16(entry + 16);
+        asset.height  = m_parent->m_hal->rd16(entry + 18);
+        m_assets.push_back(asset);
+    }
+    return count;
+}
+
+const FlashAsset * Flash::asset(uint32_t id) const
+{
+    for(const auto & a : m_assets)
+    {
+        if(a.id == id)
+            return &a;
+    }
+    return nullptr;
+}
+
+const std::vector<FlashAsset> & Flash::assets() const
+{
+    return m_assets;
+}
+
+const FlashBitmap * Flash::bitmap(string name, const FlashAsset & asset) const
+{
+    if(asset.type != FlashAssetType::Bitmap)
+    {
+        debug("Flash asset is not bitmap\n");
+        return nullptr;
+    }
+    return bitmap(name,
+                  asset.address,
+                  asset.size,
+                  asset.width,
+                  asset.height,
+                  static_cast<BitmapExtFormats>(asset.format));
+}
+
+const FlashBitmap * Flash::bitmap(string           name,
+                                  uint32_t         address,
+                                  uint32_t         size,
+                                  uint16_t         width,
+                                  uint16_t         height,
+                                  BitmapExtFormats format) const
+{
+    if(!checkFull())
+        return nullptr;
+    //Graphics engine reads only ASTC blocks from flash
+    if(!isASTC(format))
+    {
+        debug("Only ASTC bitmaps can be drawn from flash\n");
+        return nullptr;
+    }
+    //Flash bitmap source is set in 32 byte blocks
+    if((address & 31) != 0 || address + size > m_size)
+    {
+        debug("Wrong flash bitmap address\n");
+        return nullptr;
+    }
+    auto b = new FlashBitmap(name,
+                             address,
+                             size,
+                             width,
+                             height,
+                             format);
+    m_bitmaps.push_back(b);
+    return b;
+}
+
+void Flash::removeBitmap(const FlashBitmap * b) const
+{
+    auto it = std::find(m_bitmaps.begin(), m_bitmaps.end(), b);
+    if(it == m_bitmaps.end())
+        return;
+    delete *it;
+    m_bitmaps.erase(it);
+}
+
+const Atlas * Flash::atlas(string             name,
+                           const FlashAsset & asset,
+                           uint16_t           cellWidth,
+                           uint16_t           cellHeight) const
+{
+    if(!checkFull())
+        return nullptr;
+    if(asset.type != FlashAssetType::Bitmap
+       || !isASTC(static_cast<BitmapExtFormats>(asset.format))
+       || (asset.address & 31) != 0)
+    {
+        debug("Only ASTC bitmaps can be drawn from flash\n");
+        return nullptr;
+    }
+    auto a = new Atlas(name,
+                       asset.address,
+                       asset.size,
+                       static_cast<BitmapExtFormats>(asset.format),
+                       cellWidth,
+                       cellHeight,
+                       true);
+    m_atlases.push_back(a);
+    return a;
+}
+
+void Flash::removeAtlas(const Atlas * a) const
+{
+    auto it = std::find(m_atlases.begin(), m_atlases.end(), a);
+    if(it == m_atlases.end())
+        return;
+    delete *it;
+    m_atlases.erase(it);
+}
+
+bool Flash::checkFull() const
+{
+    if(m_flashStatus != FLASH_STATUS_FULL)
+    {
+        debug("Flash is not in full mode\n");
+        return false;
+    }
+    return true;
+}
+
+BitmapExtFormats FlashBitmap::format() const
+{
+    return m_format;
+}
+
+uint16_t FlashBitmap::width() const
+{
+    return m_width;
+}
+
+uint16_t FlashBitmap::height() const
+{
+    return m_height;
+}
 #endif
 
 uint32_t StoredObject::address() const
@@ -453,6 +2151,11 @@ void StoredObject::setAddress(const uint32_t & address)
     m_address = address;
 }
 
+void StoredObject::setSize(const uint32_t & size)
+{
+    m_size = size;
+}
+
 std::string StoredObject::name() const
 {
     return m_name;
@@ -463,6 +2166,95 @@ StoredObjectType StoredObject::type() const
     return m_type;
 }
 
+uint32_t StoredObject::hash() const
+{
+    return m_hash;
+}
+
+void StoredObject::setHash(uint32_t hash)
+{
+    m_hash = hash;
+}
+
+uint16_t StoredObject::refCount() const
+{
+    return m_refs;
+}
+
+void StoredObject::addRef()
+{
+    ++m_refs;
+}
+
+uint16_t StoredObject::release()
+{
+    if(m_refs != 0)
+        --m_refs;
+    return m_refs;
+}
+
+uint8_t Font::handle() const
+{
+    return m_handle;
+}
+
+uint8_t Font::firstChar() const
+{
+    return m_firstChar;
+}
+
+uint16_t Font::height() const
+{
+    return m_height;
+}
+
+uint16_t Font::width() const
+{
+    return m_width;
+}
+
+bool Font::extended() const
+{
+    return m_extended;
+}
+
+bool Font::paged() const
+{
+    return m_slots.empty() == false;
+}
+
+uint32_t Font::nextChar(const std::string & text, size_t & pos)
+{
+    auto     lead = static_cast<uint8_t>(text[pos++]);
+    uint32_t code;
+    uint8_t  tail;
+    if(lead < 0x80)
+        return lead;
+    if((lead & 0xE0) == 0xC0)
+    {
+        code = lead & 0x1F;
+        tail = 1;
+    }
+    else if((lead & 0xF0) == 0xE0)
+    {
+        code = lead & 0x0F;
+        tail = 2;
+    }
+    else if((lead & 0xF8) == 0xF0)
+    {
+        code = lead & 0x07;
+        tail = 3;
+    }
+    else
+    {
+        return lead;
+    }
+    while(tail-- != 0 && pos < text.size()
+          && (static_cast<uint8_t>(text[pos]) & 0xC0) == 0x80)
+        code = (code << 6) | (static_cast<uint8_t>(text[pos++]) & 0x3F);
+    return code;
+}
+
 SnapshotBitmapFormat Snapshot::format() const
 {
     return m_format;
@@ -488,6 +2280,26 @@ int16_t Snapshot::x() const
     return m_x;
 }
 
+uint8_t Snapshot::scale() const
+{
+    return m_scale;
+}
+
+uint16_t Snapshot::bitmapWidth() const
+{
+    return m_width / m_scale;
+}
+
+uint16_t Snapshot::bitmapHeight() const
+{
+    return m_height / m_scale;
+}
+
+uint8_t Snapshot::pixelSize() const
+{
+    return m_format == SnapshotBitmapFormat::ARGB8 ? 4 : 2;
+}
+
 SketchBitmapFormat Sketch::format() const
 {
     return m_format;
@@ -542,3 +2354,101 @@ uint16_t ImagePNG::height() const
 {
     return m_height;
 }
+
+BitmapExtFormats CompressedImage::format() const
+{
+    return m_format;
+}
+
+uint16_t CompressedImage::width() const
+{
+    return m_width;
+}
+
+uint16_t CompressedImage::height() const
+{
+    return m_height;
+}
+
+BitmapExtFormats RawBitmap::format() const
+{
+    return m_format;
+}
+
+uint16_t RawBitmap::width() const
+{
+    return m_width;
+}
+
+uint16_t RawBitmap::height() const
+{
+    return m_height;
+}
+
+BitmapExtFormats Atlas::format() const
+{
+    return m_format;
+}
+
+uint16_t Atlas::cellWidth() const
+{
+    return m_cellWidth;
+}
+
+uint16_t Atlas::cellHeight() const
+{
+    return m_cellHeight;
+}
+
+uint8_t Atlas::cellCount() const
+{
+    uint32_t cellSize = bitmapByteSize(m_format, m_cellWidth, m_cellHeight);
+    if(cellSize == 0)
+        return 0;
+    //CELL is 7 bit
+    return static_cast<uint8_t>(std::min<uint32_t>(m_size / cellSize, 128));
+}
+
+bool Atlas::inFlash() const
+{
+    return m_inFlash;
+}
+
+uint32_t Atlas::source() const
+{
+#if defined(BT81X_ENABLE)
+    if(m_inFlash)
+        return EVE::flashSource(m_address);
+#endif
+    return m_address;
+}
+
+BitmapExtFormats Palette::format() const
+{
+    return m_format;
+}
+
+uint16_t Palette::entries() const
+{
+    return static_cast<uint16_t>(m_size / (m_format == BitmapExtFormats::PALETTED8 ? 4 : 2));
+}
+
+uint16_t PalettedBitmap::width() const
+{
+    return m_width;
+}
+
+uint16_t PalettedBitmap::height() const
+{
+    return m_height;
+}
+
+const Palette * PalettedBitmap::palette() const
+{
+    return m_palette;
+}
+
+void PalettedBitmap::setPalette(const Palette * palette)
+{
+    m_palette = palette;
+}
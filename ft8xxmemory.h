@@ -6,6 +6,12 @@
 
 namespace EVE
 {
+/*!
+ * \brief DataProducer - fill buffer with next chunk of streamed data.
+ * Arguments are buffer and its size, return value is count of written bytes. 0 means end of data
+ */
+using DataProducer = mbed::Callback<uint32_t(uint8_t *, uint32_t)>;
+
 enum class StoredObjectType : uint8_t
 {
     Unknow,
@@ -14,7 +20,13 @@ enum class StoredObjectType : uint8_t
     ImageJPEG,
     ImagePNG,
     CompressedImage,
-    Sketch
+    Sketch,
+    RawBitmap,
+    FlashBitmap,
+    Atlas,
+    Palette,
+    PalettedBitmap,
+    Font
 };
 
 class StoredObject
@@ -40,14 +52,28 @@ public:
     uint32_t         address() const;
     void             setAddress(const uint32_t & address);
     uint32_t         size() const;
+    void             setSize(const uint32_t & size);
     std::string      name() const;
     StoredObjectType type() const;
+    /*!
+     * \brief hash - CRC-32 of object content used for deduplication. 0 if unknown
+     */
+    uint32_t         hash() const;
+    void             setHash(uint32_t hash);
+    /*!
+     * \brief refCount - count of owners sharing this object. Ram_G is released when last one is removed
+     */
+    uint16_t         refCount() const;
+    void             addRef();
+    uint16_t         release();
 
 protected:
     std::string      m_name{};
     uint32_t         m_address{0};
     uint32_t         m_size{0};
     StoredObjectType m_type{StoredObjectType::Unknow};
+    uint32_t         m_hash{0};
+    uint16_t         m_refs{1};
 };
 
 class DisplayList : public StoredObject
@@ -71,32 +97,32 @@ public:
              int16_t              y,
              uint16_t             width,
              uint16_t             height,
-             SnapshotBitmapFormat format) :
+             SnapshotBitmapFormat format,
+             uint8_t              scale = 1) :
         StoredObject(name, address, 0),
         m_format(format),
         m_x(x),
         m_y(y),
         m_width(width),
-        m_height(height)
+        m_height(height),
+        m_scale(scale == 0 ? 1 : scale)
     {
         m_type = StoredObjectType::Snapshot;
         //Calculate Snapshot byte size
-        switch(format)
-        {
-        case SnapshotBitmapFormat::RGB565:    //16 bit per pixel
-        case SnapshotBitmapFormat::ARGB4:     //16 bit per pixel
-            m_size = width * height * 2;
-            break;
-        case SnapshotBitmapFormat::ARGB8:    //32 bit per pixel
-            m_size = width * height * 4;
-            break;
-        }
+        m_size = bitmapWidth() * bitmapHeight() * pixelSize();
     }
     SnapshotBitmapFormat format() const;
     uint16_t             width() const;
     uint16_t             height() const;
     int16_t              y() const;
     int16_t              x() const;
+    /*!
+     * \brief scale - stored bitmap is 1/scale of captured area on each axis and magnified with bilinear filter on drawing
+     */
+    uint8_t              scale() const;
+    uint16_t             bitmapWidth() const;
+    uint16_t             bitmapHeight() const;
+    uint8_t              pixelSize() const;
 
 protected:
     SnapshotBitmapFormat m_format;
@@ -105,6 +131,7 @@ protected:
         m_y{0};
     uint16_t m_width{0},
         m_height{0};
+    uint8_t m_scale{1};
 };
 
 class Sketch : public StoredObject
@@ -227,13 +254,371 @@ protected:
 
 class FT8xx;
 
+/*!
+ * \brief CompressedImage - bitmap uploaded as zlib stream and inflated to Ram_G by CoPro.
+ * Size is known after inflating only
+ */
+class CompressedImage : public StoredObject
+{
+public:
+    CompressedImage(string           name,
+                    uint32_t         address,
+                    uint16_t         width,
+                    uint16_t         height,
+                    BitmapExtFormats format) :
+        StoredObject(name, address, 0),
+        m_format(format),
+        m_width(width),
+        m_height(height)
+    {
+        m_type = StoredObjectType::CompressedImage;
+    }
+
+    BitmapExtFormats format() const;
+    uint16_t         width() const;
+    uint16_t         height() const;
+
+protected:
+    BitmapExtFormats m_format;
+    uint16_t         m_width{0},
+        m_height{0};
+};
+
+/*!
+ * \brief RawBitmap - bitmap data already in EVE format copied to Ram_G (f.e. from flash with CMD_FLASHREAD)
+ */
+class RawBitmap : public StoredObject
+{
+public:
+    RawBitmap(string           name,
+              uint32_t         address,
+              uint32_t         size,
+              uint16_t         width,
+              uint16_t         height,
+              BitmapExtFormats format) :
+        StoredObject(name, address, size),
+        m_format(format),
+        m_width(width),
+        m_height(height)
+    {
+        m_type = StoredObjectType::RawBitmap;
+    }
+
+    BitmapExtFormats format() const;
+    uint16_t         width() const;
+    uint16_t         height() const;
+
+protected:
+    BitmapExtFormats m_format;
+    uint16_t         m_width{0},
+        m_height{0};
+};
+
+/*!
+ * \brief Atlas - one bitmap made of equal-size cells placed one under another (sprite sheet).
+ * Bind it to bitmap handle with FT8xx::setAtlas once and draw cells with FT8xx::vertexPointII(x, y, handle, cell).
+ * Bitmap can be in Ram_G or (ASTC only) in flash
+ */
+class Atlas : public StoredObject
+{
+public:
+    Atlas(string           name,
+          uint32_t         address,
+          uint32_t         size,
+          BitmapExtFormats format,
+          uint16_t         cellWidth,
+          uint16_t         cellHeight,
+          bool             inFlash = false) :
+        StoredObject(name, address, size),
+        m_format(format),
+        m_cellWidth(cellWidth),
+        m_cellHeight(cellHeight),
+        m_inFlash(inFlash)
+    {
+        m_type = StoredObjectType::Atlas;
+    }
+
+    BitmapExtFormats format() const;
+    uint16_t         cellWidth() const;
+    uint16_t         cellHeight() const;
+    uint8_t          cellCount() const;
+    bool             inFlash() const;
+    /*!
+     * \brief source - bitmap source for CMD_SETBITMAP (Ram_G address or flash source)
+     */
+    uint32_t source() const;
+
+protected:
+    BitmapExtFormats m_format;
+    uint16_t         m_cellWidth{0},
+        m_cellHeight{0};
+    bool m_inFlash{false};
+};
+
+/*!
+ * \brief Palette - colour table in Ram_G shared by paletted bitmaps.
+ * PALETTED565 and PALETTED4444 use 2 bytes per entry, PALETTED8 - 4 bytes (ARGB8)
+ */
+class Palette : public StoredObject
+{
+public:
+    Palette(string           name,
+            uint32_t         address,
+            uint32_t         size,
+            BitmapExtFormats format) :
+        StoredObject(name, address, size),
+        m_format(format)
+    {
+        m_type = StoredObjectType::Palette;
+    }
+
+    BitmapExtFormats format() const;
+    uint16_t         entries() const;
+
+protected:
+    BitmapExtFormats m_format;
+};
+
+/*!
+ * \brief PalettedBitmap - 8 bit indices in Ram_G drawn with Palette via PALETTE_SOURCE.
+ * Bitmap format is taken from palette
+ */
+class PalettedBitmap : public StoredObject
+{
+public:
+    PalettedBitmap(string          name,
+                   uint32_t        address,
+                   uint16_t        width,
+                   uint16_t        height,
+                   const Palette * palette) :
+        StoredObject(name, address, width * height),
+        m_width(width),
+        m_height(height),
+        m_palette(palette)
+    {
+        m_type = StoredObjectType::PalettedBitmap;
+    }
+
+    uint16_t        width() const;
+    uint16_t        height() const;
+    const Palette * palette() const;
+    /*!
+     * \brief setPalette - change colour table without reloading indices
+     */
+    void setPalette(const Palette * palette);
+
+protected:
+    uint16_t m_width{0},
+        m_height{0};
+    const Palette * m_palette{nullptr};
+};
+
+/*!
+ * \brief Font - custom font in Ram_G, registered for text commands by FT8xx::setFont (CMD_SETFONT2).
+ * Legacy font is 148 bytes metric block followed by glyphs of characters from firstChar up to 127.
+ * Extended font (BT81x xfont) covers UTF-8, its glyphs stay in flash: ASTC glyphs are drawn from flash,
+ * others are paged to Ram_G by 128 characters on demand (RamG::requireGlyphs)
+ */
+class Font : public StoredObject
+{
+    friend class RamG;
+
+public:
+    Font(string   name,
+         uint32_t address,
+         uint32_t size,
+         uint8_t  handle,
+         uint8_t  firstChar,
+         uint16_t height,
+         bool     extended = false) :
+        StoredObject(name, address, size),
+        m_handle(handle),
+        m_firstChar(firstChar),
+        m_height(height),
+        m_extended(extended)
+    {
+        m_type = StoredObjectType::Font;
+    }
+
+    uint8_t  handle() const;
+    uint8_t  firstChar() const;
+    uint16_t height() const;
+    /*!
+     * \brief width - width of widest glyph
+     */
+    uint16_t width() const;
+    bool     extended() const;
+    /*!
+     * \brief paged - glyphs are loaded to Ram_G slots on demand, RamG::requireGlyphs must be called before drawing
+     */
+    bool paged() const;
+
+    /*!
+     * \brief nextChar - decode UTF-8 character and move position to the next one
+     * \return code point, invalid bytes are returned as is
+     */
+    static uint32_t nextChar(const std::string & text, size_t & pos);
+
+    //xfont header
+    static constexpr uint32_t XFontSignature    = 0x0100AAFF;
+    static constexpr uint32_t XFontFormat       = 8;
+    static constexpr uint32_t XFontLayoutWidth  = 16;
+    static constexpr uint32_t XFontLayoutHeight = 20;
+    static constexpr uint32_t XFontPixelWidth   = 24;
+    static constexpr uint32_t XFontPixelHeight  = 28;
+    static constexpr uint32_t XFontChars        = 36;
+    static constexpr uint32_t XFontGptr         = 40;
+    static constexpr uint16_t NoPage            = 0xFFFF;
+
+protected:
+    struct GlyphSlot
+    {
+        uint16_t page{NoPage};
+        uint32_t lastUse{0};    //Frame of last use
+    };
+
+    uint8_t  m_handle{0};
+    uint8_t  m_firstChar{32};
+    uint16_t m_height{0};
+    uint16_t m_width{0};
+    bool     m_extended{false};
+    //Extended font
+    uint16_t m_pageCount{1};
+    uint32_t m_headerSize{0};
+    uint32_t m_glyphSource{0};    //Flash byte address of glyphs
+    uint32_t m_glyphPageSize{0};
+    uint32_t m_slotSize{0};
+    uint32_t m_linkedAddress{0};    //Ram_G address used in header pointers
+    mutable std::vector<GlyphSlot> m_slots{};
+    //Host copy of widths by pages of 128 characters, read on first use
+    mutable std::vector<std::vector<uint8_t>> m_widths{};
+};
+
+#if defined(BT81X_ENABLE)
+enum class FlashAssetType : uint16_t
+{
+    Raw       = 0,    //Any data
+    Bitmap    = 1,    //Bitmap in EVE format. ASTC can be drawn from flash directly
+    Deflate   = 2,    //zlib stream for CMD_INFLATE2
+    ImagePNG  = 3,    //PNG file for CMD_LOADIMAGE
+    ImageJPEG = 4     //JPEG file for CMD_LOADIMAGE
+};
+
+/*!
+ * \brief FlashAsset - entry of asset directory stored in flash.
+ * Directory is placed at FlashAssetDirectory by default: header {magic "EVEA", count, 0, 0} followed by count of entries
+ */
+struct FlashAsset
+{
+    uint32_t       id;
+    uint32_t       address;    //Byte address in flash
+    uint32_t       size;       //Byte size in flash
+    FlashAssetType type;
+    uint16_t       format;     //BitmapExtFormats, ImagePNGFormat or ImageJPEGFormat
+    uint16_t       width;
+    uint16_t       height;
+};
+
+static constexpr uint32_t FlashAssetDirectory  = 0x1000;        //Next to BT81x blob
+static constexpr uint32_t FlashAssetMagic      = 0x41455645;    //"EVEA"
+static constexpr uint32_t FlashAssetHeaderSize = 16;
+static constexpr uint32_t FlashAssetEntrySize  = 20;
+static constexpr uint32_t FlashSectorSize      = 4096;
+
+/*!
+ * \brief FlashBitmap - bitmap drawn by EVE straight from flash (ASTC formats only).
+ * Address is flash byte address, takes no Ram_G. Created by Flash::bitmap
+ */
+class FlashBitmap : public StoredObject
+{
+public:
+    FlashBitmap(string           name,
+                uint32_t         address,
+                uint32_t         size,
+                uint16_t         width,
+                uint16_t         height,
+                BitmapExtFormats format) :
+        StoredObject(name, address, size),
+        m_format(format),
+        m_width(width),
+        m_height(height)
+    {
+        m_type = StoredObjectType::FlashBitmap;
+    }
+
+    BitmapExtFormats format() const;
+    uint16_t         width() const;
+    uint16_t         height() const;
+
+protected:
+    BitmapExtFormats m_format;
+    uint16_t         m_width{0},
+        m_height{0};
+};
+#endif
+
+/*!
+ * \brief MediaFifo - ring buffer in Ram_G for CMD_LOADIMAGE with OPT_MEDIAFIFO.
+ * CoPro reads data from REG_MEDIAFIFO_READ while MCU writes next chunks and moves REG_MEDIAFIFO_WRITE,
+ * so image can be bigger than CoPro FIFO and MCU RAM. Created by RamG::startMediaFifo
+ */
+class MediaFifo
+{
+public:
+    static constexpr uint32_t ChunkSize = 512;
+
+    MediaFifo(FT8xx * parent, uint32_t address, uint32_t size);
+
+    uint32_t address() const;
+    uint32_t size() const;
+    uint32_t freeSpace() const;
+
+    /*!
+     * \brief write - write as much data as FIFO can take now
+     * \param data - pointer to data
+     * \param size - data size. Must be multiple of 4 except last chunk of stream
+     * \return count of written bytes
+     */
+    uint32_t write(const uint8_t * data, uint32_t size);
+
+    /*!
+     * \brief writeAll - write all data, waiting while CoPro free FIFO space
+     * \return false if CoPro fault
+     */
+    bool writeAll(const uint8_t * data, uint32_t size);
+
+private:
+    FT8xx *  m_parent;
+    uint32_t m_address{0},
+        m_size{0},
+        m_write{0};
+};
+
 class RamG
 {
 public:
-    RamG(FT8xx * parent, uint32_t size);
+    /*!
+     * \brief UploadCheck - CMD_MEMCRC checks of raw uploads (CMD_MEMWRITE).
+     * Skip - data is not sent if target region already has the same CRC (f.e. after warm reset or screen re-entry).
+     * Verify - CRC of target region is compared with source after upload instead of reading data back
+     */
+    enum class UploadCheck : uint8_t
+    {
+        None          = 0,
+        Skip          = 1,
+        Verify        = 2,
+        SkipAndVerify = 3
+    };
 
     /*!
-     * \brief Saved curent Ram_DL data to Ram_G for next using with append(...) function for reduce SPI overhead
+     * \param size - allocated size
+     * \param clear - zero Ram_G. Keep it false to reuse data loaded before warm reset
+     */
+    RamG(FT8xx * parent, uint32_t size, bool clear = true);
+
+    /*!
+     * \brief Saved curent Ram_DL data to Ram_G for next using with append(...) function for reduce SPI overhead.
+     * With deduplication enabled already stored identical list is returned with incremented reference count
      * \param name Display list name
      * \return pointer to display list memory object
      */
@@ -242,30 +627,65 @@ public:
     {
         removeStoredObject(list);
     }
+    /*!
+     * \brief removeDisplayList - remove by name. Shared list keeps name of its first owner,
+     * so with deduplication enabled remove it by pointer returned from save
+     */
     inline void removeDisplayList(std::string name) const
     {
         removeStoredObject(name);
     }
 
     DisplayList * updateDisplayList(DisplayList * list) const;
+    /*!
+     * \brief saveFragment - store part of current display list produced since FT8xx::dlOffset() to Ram_G.
+     * Current display list is not changed, so fragment is recorded while frame is drawn and then only appended
+     * \param start - Ram_DL offset before recorded commands
+     * \return pointer to display list memory object or nullptr if nothing was produced
+     */
+    DisplayList * saveFragment(string name, uint16_t start) const;
 
     //**********
+    /*!
+     * \brief saveSnapshot - capture screen area to Ram_G with CMD_SNAPSHOT2
+     * \param scale - store area downscaled by scale on each axis (2 takes 1/4 of memory).
+     * Area is captured to free Ram_G by strips of scale lines and averaged by MCU, nothing is shown on screen.
+     * Without Ram_G for one strip full size snapshot is taken instead.
+     * \note Scaled capture blocks for one CMD_SNAPSHOT2 and SPI read back of scale lines per stored line
+     * (~130 round trips and 260K read for half size 800x480), full size capture is one CMD_SNAPSHOT2
+     */
     Snapshot * saveSnapshot(string               name,
                             SnapshotBitmapFormat fmt    = SnapshotBitmapFormat::ARGB4,
                             int16_t              x      = 0,
                             int16_t              y      = 0,
                             uint16_t             width  = EVE_HSIZE,
-                            uint16_t             height = EVE_VSIZE) const;
+                            uint16_t             height = EVE_VSIZE,
+                            uint8_t              scale  = 1) const;
 
     inline void removeSnapshot(Snapshot * sn) const
     {
         removeStoredObject(sn);
     }
+    /*!
+     * \brief removeSnapshot - remove by name. Shared snapshot keeps name of its first owner,
+     * so with deduplication enabled remove it by pointer returned from save
+     */
     inline void removeSnapshot(std::string name) const
     {
         removeStoredObject(name);
     }
     Snapshot * updateSnapshot(Snapshot * s) const;
+    /*!
+     * \brief updateSnapshot - capture only dirty rectangle of snapshot area.
+     * Full width rectangle is captured in place, narrower one goes through free Ram_G and is copied by lines.
+     * Shared and scaled snapshots are captured fully
+     * \param x, y, width, height - dirty rectangle in screen coordinates
+     */
+    Snapshot * updateSnapshot(Snapshot * s,
+                              int16_t    x,
+                              int16_t    y,
+                              uint16_t   width,
+                              uint16_t   height) const;
     //**********
     Sketch * startSketch(string             name,
                          SketchBitmapFormat fmt    = SketchBitmapFormat::L1,
@@ -284,12 +704,31 @@ public:
         removeStoredObject(name);
     }
     //**********
+    /*!
+     * \brief loadPNG - send PNG file to CoPro and decode it to Ram_G with CMD_LOADIMAGE.
+     * Image size and bitmap format are taken from PNG header, decoded size is returned by CMD_GETPROPS
+     * \note CoPro use top 42K of Ram_G (from 0xF5800) as decoding buffer. Nothing can be stored there while PNG loading
+     * \param name - image name
+     * \param src - pointer to PNG file data
+     * \param size - PNG file size in bytes
+     * \param opt - CMD_LOADIMAGE options
+     * \return pointer to image memory object or nullptr if decoding failed
+     */
     ImagePNG * loadPNG(string          name,
                        const uint8_t * src,
-                       ImagePNGFormat  fmt,
-                       uint16_t        width  = EVE_HSIZE,
-                       uint16_t        height = EVE_VSIZE,
-                       LoadImageOpt    opt    = LoadImageOpt::NoDL) const;
+                       uint32_t        size,
+                       LoadImageOpt    opt = LoadImageOpt::NoDL) const;
+
+    /*!
+     * \brief loadPNG - stream PNG file through MediaFIFO. RamG::startMediaFifo must be called before
+     * \param name - image name
+     * \param producer - callback returns next chunks of PNG file
+     * \param opt - CMD_LOADIMAGE options. OPT_MEDIAFIFO is added
+     * \return pointer to image memory object or nullptr if decoding failed
+     */
+    ImagePNG * loadPNG(string       name,
+                       DataProducer producer,
+                       LoadImageOpt opt = LoadImageOpt::NoDL) const;
 
     inline void removePNG(ImagePNG * i)
     {
@@ -301,7 +740,268 @@ public:
         removeStoredObject(name);
     }
     //**********
+    /*!
+     * \brief loadJPEG - send baseline JPEG file to CoPro and decode it to Ram_G with CMD_LOADIMAGE.
+     * \param name - image name
+     * \param src - pointer to JPEG file data
+     * \param size - JPEG file size in bytes
+     * \param fmt - decoded bitmap format. L8 uses OPT_MONO
+     * \param opt - CMD_LOADIMAGE options
+     * \return pointer to image memory object or nullptr if decoding failed
+     */
+    ImageJPEG * loadJPEG(string          name,
+                         const uint8_t * src,
+                         uint32_t        size,
+                         ImageJPEGFormat fmt = ImageJPEGFormat::RGB565,
+                         LoadImageOpt    opt = LoadImageOpt::NoDL) const;
+
+    /*!
+     * \brief loadJPEG - stream baseline JPEG file through MediaFIFO. RamG::startMediaFifo must be called before.
+     * Image size is taken from SOF marker before decoding, so SOF must be in first 1 KB of the file
+     * \param name - image name
+     * \param producer - callback returns next chunks of JPEG file
+     * \param fmt - decoded bitmap format. L8 uses OPT_MONO
+     * \param opt - CMD_LOADIMAGE options. OPT_MEDIAFIFO is added
+     * \return pointer to image memory object or nullptr if decoding failed
+     */
+    ImageJPEG * loadJPEG(string          name,
+                         DataProducer    producer,
+                         ImageJPEGFormat fmt = ImageJPEGFormat::RGB565,
+                         LoadImageOpt    opt = LoadImageOpt::NoDL) const;
+
+    inline void removeJPEG(ImageJPEG * i) const
+    {
+        removeStoredObject(i);
+    }
+
+    inline void removeJPEG(std::string name) const
+    {
+        removeStoredObject(name);
+    }
+    //**********
+    /*!
+     * \brief inflate - send zlib compressed bitmap to CoPro and decompress it to Ram_G with CMD_INFLATE.
+     * Inflated size is returned by CMD_GETPTR
+     * \param name - image name
+     * \param src - pointer to zlib data (see tools/eve_deflate.py)
+     * \param size - compressed data size in bytes
+     * \param fmt - bitmap format of inflated data
+     * \param width - bitmap width
+     * \param height - bitmap height
+     * \return pointer to image memory object or nullptr if inflating failed
+     */
+    CompressedImage * inflate(string           name,
+                              const uint8_t *  src,
+                              uint32_t         size,
+                              BitmapExtFormats fmt,
+                              uint16_t         width,
+                              uint16_t         height) const;
+#if defined(BT81X_ENABLE)
+    /*!
+     * \brief inflate - stream zlib compressed bitmap through MediaFIFO with CMD_INFLATE2.
+     * RamG::startMediaFifo must be called before
+     * \param producer - callback returns next chunks of zlib data
+     */
+    CompressedImage * inflate(string           name,
+                              DataProducer     producer,
+                              BitmapExtFormats fmt,
+                              uint16_t         width,
+                              uint16_t         height) const;
+#endif
+
+    inline void removeCompressedImage(CompressedImage * i) const
+    {
+        removeStoredObject(i);
+    }
+
+    inline void removeCompressedImage(std::string name) const
+    {
+        removeStoredObject(name);
+    }
+    //**********
+    /*!
+     * \brief loadAtlas - upload sprite sheet to Ram_G with CMD_MEMWRITE
+     * \param name - atlas name
+     * \param data - bitmap data in EVE format, cells placed one under another
+     * \param size - data size in bytes
+     * \param fmt - bitmap format
+     * \param cellWidth - width of one cell
+     * \param cellHeight - height of one cell
+     * \param crc - precomputed CRC-32 of data for upload check. 0 - calculate
+     * \return pointer to atlas memory object
+     */
+    Atlas * loadAtlas(string           name,
+                      const uint8_t *  data,
+                      uint32_t         size,
+                      BitmapExtFormats fmt,
+                      uint16_t         cellWidth,
+                      uint16_t         cellHeight,
+                      uint32_t         crc = 0) const;
+#if defined(BT81X_ENABLE)
+    /*!
+     * \brief loadAtlas - copy (Bitmap asset) or inflate (Deflate asset) sprite sheet from flash to Ram_G
+     */
+    Atlas * loadAtlas(string             name,
+                      const FlashAsset & asset,
+                      uint16_t           cellWidth,
+                      uint16_t           cellHeight) const;
+#endif
+
+    inline void removeAtlas(Atlas * a) const
+    {
+        removeStoredObject(a);
+    }
+
+    inline void removeAtlas(std::string name) const
+    {
+        removeStoredObject(name);
+    }
+    //**********
+    /*!
+     * \brief loadPalette - upload colour table to Ram_G with CMD_MEMWRITE
+     * \param name - palette name
+     * \param lut - colour table
+     * \param size - table size in bytes
+     * \param fmt - PALETTED565, PALETTED4444 or PALETTED8
+     * \param crc - precomputed CRC-32 of lut for upload check. 0 - calculate
+     * \return pointer to palette memory object or nullptr if format is not paletted
+     */
+    Palette * loadPalette(string           name,
+                          const uint8_t *  lut,
+                          uint32_t         size,
+                          BitmapExtFormats fmt,
+                          uint32_t         crc = 0) const;
+    /*!
+     * \brief loadPaletted - upload 8 bit indices of paletted bitmap to Ram_G with CMD_MEMWRITE
+     * \param palette - colour table. Can be shared by many bitmaps
+     * \param crc - precomputed CRC-32 of indices for upload check. 0 - calculate
+     */
+    PalettedBitmap * loadPaletted(string          name,
+                                  const uint8_t * indices,
+                                  uint16_t        width,
+                                  uint16_t        height,
+                                  const Palette * palette,
+                                  uint32_t        crc = 0) const;
+#if defined(BT81X_ENABLE)
+    Palette *        loadPalette(string name, const FlashAsset & asset) const;
+    PalettedBitmap * loadPaletted(string             name,
+                                  const FlashAsset & asset,
+                                  const Palette *    palette) const;
+#endif
+
+    /*!
+     * \brief removePalette - remove palette. Bitmaps used it are left without palette and not drawn
+     */
+    inline void removePalette(Palette * p) const
+    {
+        removeStoredObject(p);
+    }
+
+    inline void removePaletted(PalettedBitmap * b) const
+    {
+        removeStoredObject(b);
+    }
+    //**********
+    /*!
+     * \brief loadFont - upload legacy font (metric block and glyphs) with CMD_MEMWRITE.
+     * Glyph pointer of metric block is set to glyphs just after it
+     * \param handle - bitmap handle used for font (0...31). Handles 0...14 are taken from bitmap cache while font is set
+     * \param data - font file
+     * \param size - font file size
+     * \param firstChar - first character of glyphs
+     * \param crc - precomputed CRC-32 of glyphs (data after 148 byte metric block) for upload check. 0 - calculate
+     * \return pointer to font memory object or nullptr if data is not font
+     */
+    Font * loadFont(string          name,
+                    uint8_t         handle,
+                    const uint8_t * data,
+                    uint32_t        size,
+                    uint8_t         firstChar = 32,
+                    uint32_t        crc       = 0) const;
+#if defined(BT81X_ENABLE)
+    /*!
+     * \brief loadFont - load extended font header (xfont generated for Ram_G address 0) from flash.
+     * ASTC glyphs are drawn from flash. Glyphs of other formats are paged to residentPages slots in Ram_G,
+     * least recently used page not needed by current or displayed frame is replaced
+     * \param header - xfont asset
+     * \param glyphs - glyph data asset
+     * \param residentPages - count of 128 characters pages kept in Ram_G
+     */
+    Font * loadFont(string             name,
+                    uint8_t            handle,
+                    const FlashAsset & header,
+                    const FlashAsset & glyphs,
+                    uint8_t            residentPages = 4) const;
+#endif
+    /*!
+     * \brief requireGlyphs - make glyphs of UTF-8 text resident in Ram_G before it is drawn
+     * \return false if text needs more pages than font slots
+     */
+    bool    requireGlyphs(const Font * font, const std::string & text) const;
+    /*!
+     * \brief glyphWidth - advance width of character. Widths are read from Ram_G once per page of 128 characters
+     */
+    uint8_t glyphWidth(const Font * font, uint32_t code) const;
+
+    inline void removeFont(Font * f) const
+    {
+        removeStoredObject(f);
+    }
+    //**********
+#if defined(BT81X_ENABLE)
+    /*!
+     * \brief loadFromFlash - copy or decode flash asset to Ram_G.
+     * Bitmap and Raw assets are copied with CMD_FLASHREAD, Deflate assets are inflated with CMD_INFLATE2,
+     * PNG and JPEG are decoded with CMD_LOADIMAGE. Flash source is set by CMD_FLASHSOURCE
+     * \param name - object name
+     * \param asset - asset from Flash::asset(id)
+     * \return pointer to memory object or nullptr if failed
+     */
+    StoredObject * loadFromFlash(string name, const FlashAsset & asset) const;
+#endif
+    //**********
+    /*!
+     * \brief startMediaFifo - carve MediaFIFO ring buffer from the top of allocated Ram_G and start it with CMD_MEDIAFIFO
+     * \param size - FIFO size in bytes, multiple of 4
+     * \return pointer to FIFO or nullptr if not enough free space
+     */
+    MediaFifo * startMediaFifo(uint32_t size = 0x10000);
+    /*!
+     * \brief stopMediaFifo - return FIFO memory to Ram_G
+     */
+    void        stopMediaFifo();
+    MediaFifo * mediaFifo() const;
+    //**********
+    /*!
+     * \brief setDeduplicate - share one Ram_G allocation between identical display lists and snapshots.
+     * Content is compared by CMD_MEMCRC, each save of the same data increments reference count
+     * and each remove decrements it. Updating shared object makes its own copy.
+     * Shared object keeps name of its first owner, so it must be removed by pointer
+     */
+    void        setDeduplicate(bool enable);
+    bool        deduplicate() const;
+    //**********
+    /*!
+     * \brief setUploadCheck - enable CMD_MEMCRC checks, disabled by default.
+     * With Skip removed objects are not zeroed, so their data can be found again
+     */
+    void        setUploadCheck(UploadCheck check);
+    UploadCheck uploadCheck() const;
+    /*!
+     * \brief memCrc - CRC-32 of Ram_G region calculated by CoPro with CMD_MEMCRC
+     */
+    uint32_t memCrc(uint32_t ptr, uint32_t num) const;
+    /*!
+     * \brief crc32 - CRC-32 on MCU side, the same as CMD_MEMCRC (and zlib crc32)
+     * \param crc - CRC of previous data block to continue
+     */
+    static uint32_t crc32(const uint8_t * data, uint32_t size, uint32_t crc = 0);
+    //**********
     const std::vector<StoredObject *> & pool() const;
+    /*!
+     * \brief freeSpace - bytes left after allocated objects
+     */
+    uint32_t freeSpace() const;
 
 private:
     /* Raw memory commands. Users actually does'n use in directly.
@@ -312,9 +1012,67 @@ private:
     void    memSet(uint32_t ptr, uint8_t value, uint32_t num) const;
     void    removeStoredObject(StoredObject * o) const;
     void    removeStoredObject(std::string name) const;
+    void    releasePalette(const StoredObject * o) const;
+    bool    keepContent() const;
+    void    takeSnapshot(SnapshotBitmapFormat fmt,
+                         uint32_t             ptr,
+                         int16_t              x,
+                         int16_t              y,
+                         uint16_t             width,
+                         uint16_t             height) const;
+    void    captureSnapshot(const Snapshot * s) const;
+    bool    stripFits(const Snapshot * s) const;
+    StoredObject * findDuplicate(const StoredObject * o) const;
+    void           linkFont(Font * f) const;
+    uint32_t       glyphPointer(const Font * f, uint16_t page) const;
+    bool           loadGlyphPage(const Font * f, uint16_t page, uint32_t frame) const;
+    void    memWrite(uint32_t ptr, const uint8_t * data, uint32_t num, uint32_t crc = 0) const;
     void    alignMemory() const;
     void    findMemGap();
-    FT8xx * m_parent;
+
+    ImagePNG *  decodePNG(string          name,
+                          const uint8_t * head,
+                          uint32_t        headSize,
+                          DataProducer    tail,
+                          LoadImageOpt    opt) const;
+    ImageJPEG * decodeJPEG(string          name,
+                           const uint8_t * head,
+                           uint32_t        headSize,
+                           DataProducer    tail,
+                           ImageJPEGFormat fmt,
+                           LoadImageOpt    opt) const;
+    CompressedImage * storeInflated(string           name,
+                                    uint32_t         address,
+                                    BitmapExtFormats fmt,
+                                    uint16_t         width,
+                                    uint16_t         height) const;
+    uint32_t    loadImage(uint32_t        address,
+                          const uint8_t * src,
+                          uint32_t        size,
+                          LoadImageOpt    opt) const;
+    uint32_t    streamImage(uint32_t        address,
+                            const uint8_t * head,
+                            uint32_t        headSize,
+                            DataProducer    tail,
+                            LoadImageOpt    opt) const;
+    static bool parsePNGHeader(const uint8_t *  src,
+                               uint32_t         size,
+                               uint16_t &       width,
+                               uint16_t &       height,
+                               ImagePNGFormat & fmt);
+    static bool parseJPEGHeader(const uint8_t * src,
+                                uint32_t        size,
+                                uint16_t &      width,
+                                uint16_t &      height);
+    //PNG signature, IHDR, full PLTE and header of next chunk (tRNS check)
+    static constexpr uint32_t PNGHeaderSize = 824;
+    //JFIF/EXIF markers before SOF of streamed JPEG. Larger metadata must be stripped
+    static constexpr uint32_t JPEGHeaderSize = 1024;
+
+    FT8xx *     m_parent;
+    MediaFifo * m_mediaFifo{nullptr};
+    UploadCheck m_uploadCheck{UploadCheck::None};
+    bool        m_deduplicate{false};
 
     uint32_t m_start{0x0},
         m_size{0x0};
@@ -327,13 +1085,95 @@ class Flash
 {
 public:
     Flash(FT8xx * parent, uint32_t size);
+    ~Flash();
 
     FlashStatus flashStatus() const;
+    uint32_t    size() const;
+
+    /*!
+     * \brief read - copy flash data to Ram_G with CMD_FLASHREAD
+     * \param dest - Ram_G address, 4 byte aligned
+     * \param src - flash address, 64 byte aligned
+     * \param num - byte count, multiple of 4
+     */
+    bool read(uint32_t dest, uint32_t src, uint32_t num) const;
+    /*!
+     * \brief write - write data from MCU to erased flash with CMD_FLASHWRITE
+     * \param dest - flash address, 256 byte aligned
+     * \param data - pointer to data
+     * \param num - byte count, multiple of 256
+     */
+    bool write(uint32_t dest, const uint8_t * data, uint32_t num) const;
+    /*!
+     * \brief update - write Ram_G data to flash with CMD_FLASHUPDATE. Only changed sectors are erased and written
+     * \param dest - flash address, 4096 byte aligned
+     * \param src - Ram_G address, 4 byte aligned
+     * \param num - byte count, multiple of 4096
+     */
+    bool update(uint32_t dest, uint32_t src, uint32_t num) const;
+    /*!
+     * \brief update - write data from MCU to flash sector by sector through Ram_G scratch (PNG decoding buffer)
+     * and CMD_FLASHUPDATE. Partial last sector keeps old flash content
+     * \param dest - flash address, 4096 byte aligned
+     */
+    bool update(uint32_t dest, const uint8_t * data, uint32_t num) const;
+    /*!
+     * \brief erase - erase whole flash with CMD_FLASHERASE
+     */
+    bool erase() const;
+    /*!
+     * \brief source - set flash address for next command with EVE_OPT_FLASH (CMD_FLASHSOURCE)
+     * \param src - flash address, 64 byte aligned
+     */
+    void source(uint32_t src) const;
+
+    /*!
+     * \brief loadDirectory - read asset directory from flash
+     * \param address - flash address of directory, blobAddress of eve_asset_pack.py header
+     * \return count of assets, 0 if directory is not found
+     */
+    uint32_t                        loadDirectory(uint32_t address = FlashAssetDirectory) const;
+    const FlashAsset *              asset(uint32_t id) const;
+    const std::vector<FlashAsset> & assets() const;
+
+    /*!
+     * \brief bitmap - make bitmap object for drawing straight from flash with FT8xx::append.
+     * Flash must be in full mode. Only ASTC formats can be drawn from flash
+     * \param name - bitmap name
+     * \param asset - Bitmap asset from directory
+     * \return pointer to bitmap owned by Flash or nullptr if asset can't be drawn from flash
+     */
+    const FlashBitmap * bitmap(string name, const FlashAsset & asset) const;
+    const FlashBitmap * bitmap(string           name,
+                               uint32_t         address,
+                               uint32_t         size,
+                               uint16_t         width,
+                               uint16_t         height,
+                               BitmapExtFormats format) const;
+    void                removeBitmap(const FlashBitmap * b) const;
+
+    /*!
+     * \brief atlas - make ASTC sprite sheet drawn straight from flash. Owned by Flash
+     */
+    const Atlas * atlas(string             name,
+                        const FlashAsset & asset,
+                        uint16_t           cellWidth,
+                        uint16_t           cellHeight) const;
+    void          removeAtlas(const Atlas * a) const;
 
 private:
-    FT8xx *     m_parent;
-    uint32_t    m_size{0};
-    FlashStatus m_flashStatus{FLASH_STATUS_DETACHED};
+    //Ram_G area used as temporary buffer. CoPro overwrite it while PNG decoding anyway
+    static constexpr uint32_t ScratchAddress = EVE_RAM_PNG_BUFFER;
+    static constexpr uint32_t ScratchSize    = EVE_RAM_PNG_BUFFER_SIZE;
+
+    bool checkFull() const;
+
+    FT8xx *                            m_parent;
+    uint32_t                           m_size{0};
+    FlashStatus                        m_flashStatus{FLASH_STATUS_DETACHED};
+    mutable std::vector<FlashAsset>    m_assets;
+    mutable std::vector<FlashBitmap *> m_bitmaps;
+    mutable std::vector<Atlas *>       m_atlases;
 };
 #endif
 }    // namespace EVE
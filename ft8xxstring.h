@@ -0,0 +1,70 @@
+#ifndef FT8XXSTRING_H
+#define FT8XXSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace EVE
+{
+/*!
+ * \brief StringPacker - pack string arguments of CoPro commands to 32 bit FIFO words.
+ * String may be given in several parts (f.e. CMD_TOGGLE labels), unfinished word is kept between them.
+ * Doesn't depend on driver, so packing is checked on host (tests/stringpacker_test.cpp)
+ */
+class StringPacker
+{
+public:
+    /*!
+     * \brief add - append part of string, full words are given to push
+     * \param push - callable taking uint32_t word
+     */
+    template<typename Push>
+    void add(const char * text, size_t length, Push && push)
+    {
+        //Finish word started by previous part
+        while(m_used != 0 && length != 0)
+        {
+            m_word[m_used++] = static_cast<uint8_t>(*text++);
+            --length;
+            if(m_used == 4)
+                flush(push);
+        }
+        if(length == 0)
+            return;
+        //Whole words are copied as is
+        for(; length >= 4; text += 4, length -= 4)
+        {
+            memcpy(m_word, text, 4);
+            flush(push);
+        }
+        memcpy(m_word, text, length);
+        m_used = static_cast<uint8_t>(length);
+    }
+
+    /*!
+     * \brief finish - push last zero padded word. Text aligned to 4 byte gets 4 zero byte as terminator
+     */
+    template<typename Push>
+    void finish(Push && push)
+    {
+        flush(push);
+    }
+
+private:
+    template<typename Push>
+    void flush(Push && push)
+    {
+        uint32_t word;
+        memcpy(&word, m_word, 4);
+        push(word);
+        memset(m_word, 0, 4);
+        m_used = 0;
+    }
+
+    uint8_t m_word[4]{0, 0, 0, 0};
+    uint8_t m_used{0};
+};
+}    // namespace EVE
+
+#endif    // FT8XXSTRING_H
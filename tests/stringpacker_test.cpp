@@ -0,0 +1,80 @@
+/*
+ * Host check of CoPro string packing. No driver or mbed needed:
+ *   g++ -std=c++14 -I.. stringpacker_test.cpp -o stringpacker_test && ./stringpacker_test
+ */
+#include <ft8xxstring.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using EVE::StringPacker;
+
+namespace
+{
+int failures = 0;
+
+//Bytes sent to FIFO for string given in parts
+std::vector<uint8_t> pack(const std::vector<std::string> & parts)
+{
+    std::vector<uint8_t> bytes;
+    auto                 push = [&bytes](uint32_t word) {
+        uint8_t b[4];
+        memcpy(b, &word, 4);
+        bytes.insert(bytes.end(), b, b + 4);
+    };
+    StringPacker packer;
+    for(const auto & p : parts)
+        packer.add(p.data(), p.size(), push);
+    packer.finish(push);
+    return bytes;
+}
+
+//Expected FIFO content: text, terminating zero, padding to 4 byte
+std::vector<uint8_t> expected(const std::string & text)
+{
+    std::vector<uint8_t> bytes(text.begin(), text.end());
+    bytes.push_back(0);
+    while(bytes.size() % 4 != 0)
+        bytes.push_back(0);
+    return bytes;
+}
+
+void check(const std::vector<std::string> & parts, const char * name)
+{
+    std::string joined;
+    for(const auto & p : parts)
+        joined += p;
+    if(pack(parts) != expected(joined))
+    {
+        printf("FAIL %s\n", name);
+        ++failures;
+    }
+}
+}    // namespace
+
+int main()
+{
+    check({""}, "empty");
+    check({"abc"}, "short");
+    check({"abcd"}, "aligned gets zero word");
+    check({"abcdefghi"}, "long");
+    //CMD_TOGGLE labels: off, 0xFF, on
+    check({"no", "\xff", "yes"}, "toggle no/yes");
+    check({"", "\xff", ""}, "toggle empty labels");
+    check({"off", "\xff", "on"}, "toggle off/on");
+    check({"a", "\xff", "abcdefg"}, "toggle long on");
+    check({"abcdefg", "\xff", "a"}, "toggle long off");
+    //Every split of text in two and three parts
+    const std::string text = "0123456789";
+    for(size_t i = 0; i <= text.size(); ++i)
+    {
+        check({text.substr(0, i), text.substr(i)}, "two parts");
+        for(size_t j = i; j <= text.size(); ++j)
+            check({text.substr(0, i), text.substr(i, j - i), text.substr(j)}, "three parts");
+    }
+
+    if(failures == 0)
+        printf("stringpacker: OK\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/*
+ * Host timing of TouchFilter against former deque and sort filtering of ApplicationWindow on the same trace:
+ *   g++ -std=c++14 -O2 -I../GUI touchfilter_bench.cpp ../GUI/touchfilter.cpp -o touchfilter_bench && ./touchfilter_bench
+ * Host time only shows the ratio, absolute numbers on MCU are higher
+ */
+#include <touchfilter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <stdio.h>
+#include <vector>
+
+using FTGUI::TouchFilter;
+
+namespace
+{
+struct Point
+{
+    int16_t x, y;
+};
+
+//Former filter: 13 samples are sorted, 3 lowest and 3 highest are dropped and [3] of rest is median
+class DequeFilter
+{
+public:
+    bool push(int16_t x, int16_t y)
+    {
+        m_xFifo.push_back(x);
+        m_yFifo.push_back(y);
+        if(m_xFifo.size() <= 12)
+            return false;
+        std::sort(m_xFifo.begin(), m_xFifo.end());
+        std::sort(m_yFifo.begin(), m_yFifo.end());
+        for(int i = 0; i < 3; ++i)
+        {
+            m_xFifo.pop_front();
+            m_yFifo.pop_front();
+            m_xFifo.pop_back();
+            m_yFifo.pop_back();
+        }
+        m_x = m_xFifo[3];
+        m_y = m_yFifo[3];
+        return true;
+    }
+    int16_t x() const { return m_x; }
+    int16_t y() const { return m_y; }
+
+private:
+    std::deque<int16_t> m_xFifo, m_yFifo;
+    int16_t             m_x{0}, m_y{0};
+};
+
+template<typename Filter>
+double nsPerSample(const std::vector<Point> & trace, int rounds, int32_t & checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; ++r)
+    {
+        Filter filter;
+        for(const auto & p : trace)
+        {
+            if(filter.push(p.x, p.y))
+                checksum += filter.x() + filter.y();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(rounds) * trace.size());
+}
+
+//Same window and cadence as former filter
+struct DefaultTouchFilter : TouchFilter
+{
+    DefaultTouchFilter() :
+        TouchFilter(13, 6, TouchFilter::Median) {}
+};
+}    // namespace
+
+int main()
+{
+    //Noisy drag, the same generator as touchfilter_test
+    std::vector<Point> trace;
+    uint32_t           seed = 12345;
+    for(int i = 0; i < 500; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int16_t x = static_cast<int16_t>(i + (seed >> 16) % 32);
+        seed      = seed * 1103515245 + 12345;
+        int16_t y = static_cast<int16_t>(240 + (seed >> 16) % 32);
+        trace.push_back({x, y});
+    }
+
+    const int rounds   = 2000;
+    int32_t   checksum = 0;
+    //Warm up caches and allocator
+    nsPerSample<DequeFilter>(trace, rounds / 10, checksum);
+    nsPerSample<DefaultTouchFilter>(trace, rounds / 10, checksum);
+
+    double deque  = nsPerSample<DequeFilter>(trace, rounds, checksum);
+    double filter = nsPerSample<DefaultTouchFilter>(trace, rounds, checksum);
+    printf("deque + sort: %7.1f ns/sample\n", deque);
+    printf("TouchFilter:  %7.1f ns/sample (%.1fx)\n", filter, deque / filter);
+    printf("checksum %ld\n", static_cast<long>(checksum));
+    return 0;
+}
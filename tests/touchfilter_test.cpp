@@ -0,0 +1,174 @@
+/*
+ * Host check of TouchFilter against straightforward sort of last samples. TouchFilter needs only stdint.h:
+ *   g++ -std=c++14 -I../GUI touchfilter_test.cpp ../GUI/touchfilter.cpp -o touchfilter_test && ./touchfilter_test
+ */
+#include <touchfilter.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdio.h>
+#include <vector>
+
+using FTGUI::TouchFilter;
+
+namespace
+{
+int failures = 0;
+
+struct Point
+{
+    int16_t x, y;
+};
+
+//Swipe with touch panel jitter and single sample spikes (9, 23, 24, 41)
+const Point swipe[] = {
+    {124, 299}, {129, 296}, {132, 294}, {140, 293}, {144, 290}, {148, 288},
+    {149, 287}, {157, 285}, {158, 279}, {93, 145}, {168, 279}, {172, 275},
+    {178, 273}, {182, 272}, {189, 271}, {190, 267}, {195, 266}, {201, 262},
+    {207, 261}, {210, 261}, {215, 257}, {218, 258}, {223, 255}, {330, 350},
+    {94, 398}, {235, 247}, {239, 247}, {248, 243}, {250, 242}, {254, 238},
+    {262, 238}, {264, 237}, {268, 234}, {272, 232}, {278, 230}, {282, 227},
+    {287, 227}, {291, 224}, {294, 223}, {302, 218}, {305, 217}, {427, 136},
+    {314, 215}, {318, 214}, {322, 209}, {329, 208}, {330, 207}, {338, 203},
+    {338, 202}, {345, 200}, {352, 196}, {356, 194}, {357, 195}, {365, 193},
+    {368, 190}, {372, 189}, {376, 186}, {382, 184}, {387, 183}, {393, 180},
+    {394, 177}, {399, 177}, {403, 175}, {411, 168},
+};
+
+//Reference: sort of last window samples
+class Reference
+{
+public:
+    Reference(uint8_t window, TouchFilter::Mode mode) :
+        m_window(window), m_mode(mode) {}
+
+    void push(Point p)
+    {
+        m_samples.push_back(p);
+        if(m_samples.size() > m_window)
+            m_samples.pop_front();
+    }
+    int16_t x() const { return value(&Point::x); }
+    int16_t y() const { return value(&Point::y); }
+
+private:
+    int16_t value(int16_t Point::*axis) const
+    {
+        std::vector<int16_t> v;
+        for(const auto & p : m_samples)
+            v.push_back(p.*axis);
+        std::sort(v.begin(), v.end());
+        if(m_mode == TouchFilter::Median)
+            return v[v.size() / 2];
+        size_t  trim = v.size() / 4;
+        int32_t sum  = 0;
+        for(size_t i = trim; i < v.size() - trim; ++i)
+            sum += v[i];
+        return static_cast<int16_t>(sum / static_cast<int32_t>(v.size() - 2 * trim));
+    }
+
+    size_t            m_window;
+    TouchFilter::Mode m_mode;
+    std::deque<Point> m_samples;
+};
+
+void expect(bool ok, const char * what, int window, int latency, int sample)
+{
+    if(ok)
+        return;
+    printf("FAIL %s (window %d, latency %d, sample %d)\n", what, window, latency, sample);
+    ++failures;
+}
+
+//Filtered points and their cadence match reference on trace for every window and latency
+void checkTrace(const std::vector<Point> & trace, TouchFilter::Mode mode)
+{
+    for(uint8_t window = 1; window <= TouchFilter::MaxWindow; ++window)
+    {
+        for(uint8_t latency = 1; latency <= window; ++latency)
+        {
+            TouchFilter filter(window, latency, mode);
+            Reference   reference(window, mode);
+            for(size_t i = 0; i < trace.size(); ++i)
+            {
+                bool ready = filter.push(trace[i].x, trace[i].y);
+                reference.push(trace[i]);
+                expect(ready == ((i + 1) % latency == 0), "cadence", window, latency, int(i));
+                expect(filter.x() == reference.x() && filter.y() == reference.y(),
+                       mode == TouchFilter::Median ? "median" : "trimmed mean",
+                       window,
+                       latency,
+                       int(i));
+            }
+        }
+    }
+}
+
+void checkEdges()
+{
+    //Out of range settings are clamped
+    TouchFilter filter(0, 0);
+    expect(filter.window() == 1 && filter.latency() == 1, "zero clamp", 0, 0, 0);
+    filter.setWindow(100);
+    expect(filter.window() == TouchFilter::MaxWindow, "window clamp", 100, 0, 0);
+    filter.setLatency(100);
+    expect(filter.latency() == TouchFilter::MaxWindow, "latency clamp", 16, 100, 0);
+    //Smaller window lowers latency
+    filter.setWindow(4);
+    expect(filter.latency() == 4, "latency follows window", 4, 4, 0);
+
+    //Window 1 passes samples as is
+    filter.setWindow(1);
+    for(const auto & p : swipe)
+    {
+        expect(filter.push(p.x, p.y), "window 1 ready", 1, 1, 0);
+        expect(filter.x() == p.x && filter.y() == p.y, "window 1 value", 1, 1, 0);
+    }
+
+    //Reset starts from empty window: no point before latency, old samples are not used
+    TouchFilter touch(5, 3);
+    for(int i = 0; i < 7; ++i)
+        touch.push(1000, 1000);
+    touch.reset();
+    expect(touch.x() == 0 && touch.y() == 0, "empty after reset", 5, 3, 0);
+    expect(!touch.push(10, 20) && !touch.push(11, 21), "latency after reset", 5, 3, 0);
+    expect(touch.push(12, 22) && touch.x() == 11 && touch.y() == 21, "first point after reset", 5, 3, 2);
+
+    //Equal samples leave sorted window one by one
+    TouchFilter same(3, 1);
+    same.push(5, 5);
+    same.push(5, 5);
+    same.push(7, 7);
+    same.push(9, 9);
+    expect(same.x() == 7, "duplicates", 3, 1, 3);
+    same.push(9, 9);
+    expect(same.x() == 9, "duplicates leave", 3, 1, 4);
+}
+}    // namespace
+
+int main()
+{
+    std::vector<Point> trace(std::begin(swipe), std::end(swipe));
+    checkTrace(trace, TouchFilter::Median);
+    checkTrace(trace, TouchFilter::TrimmedMean);
+
+    //Longer noisy trace with many equal values
+    std::vector<Point> noise;
+    uint32_t           seed = 12345;
+    for(int i = 0; i < 500; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int16_t x = static_cast<int16_t>((seed >> 16) % 32);
+        seed      = seed * 1103515245 + 12345;
+        int16_t y = static_cast<int16_t>((seed >> 16) % 800) - 400;
+        noise.push_back({x, y});
+    }
+    checkTrace(noise, TouchFilter::Median);
+    checkTrace(noise, TouchFilter::TrimmedMean);
+
+    checkEdges();
+
+    if(failures == 0)
+        printf("touchfilter: OK\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+#!/usr/bin/env python3
+"""
+eve_asset_pack - convert images offline and pack them to BT81x flash blob with asset directory.
+
+Every input is given as NAME=PATH[:FORMAT[:WIDTHxHEIGHT]]
+    PNG input     FORMAT: PNG (default, decoded by CMD_LOADIMAGE), RGB565, ARGB4, ARGB1555, L8,
+                          PALETTED565, PALETTED4444, PALETTED8
+    JPEG input    FORMAT: JPEG (default, RGB565 by CMD_LOADIMAGE) or L8 (CMD_LOADIMAGE with OPT_MONO)
+    .astc input   ASTC file from astcenc, block size taken from header. Drawn from flash with FlashBitmap
+    raw input     FORMAT and WIDTHxHEIGHT are required, data must be already in EVE format
+
+Paletted images must have no more than 256 colours. Palette goes to separate asset NAME_lut.
+Bitmaps are deflated (CMD_INFLATE2) when it saves at least 20%, ASTC is never deflated.
+
+Output:
+    blob   - binary to be written to flash at --base (default 0x1000, right after BT81x blob)
+             with Flash::update. Starts with asset directory read by Flash::loadDirectory.
+             Other base must be given to FT8xx::flashInit(size, Assets::blobAddress)
+    header - constexpr EVE::FlashAsset descriptors for RamG::loadFromFlash and Flash::bitmap,
+             so device doesn't parse anything
+
+Usage:
+    eve_asset_pack.py -o assets.bin --header assets.h bg=bg.astc icons=icons.png:ARGB4 logo=logo.jpg
+
+PNG decoding uses Pillow when installed, otherwise built-in decoder (8 bit, not interlaced).
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+# EVE.h BitmapExtFormats
+FORMATS = {
+    "ARGB1555": 0,
+    "L8": 3,
+    "ARGB4": 6,
+    "RGB565": 7,
+    "PALETTED565": 14,
+    "PALETTED4444": 15,
+    "PALETTED8": 16,
+}
+ASTC_BLOCKS = ["4x4", "5x4", "5x5", "6x5", "6x6", "8x5", "8x6", "8x8",
+               "10x5", "10x6", "10x8", "10x10", "12x10", "12x12"]
+ASTC_BASE = 37808
+
+# ft8xxmemory.h FlashAssetType
+TYPE_RAW, TYPE_BITMAP, TYPE_DEFLATE, TYPE_PNG, TYPE_JPEG = range(5)
+TYPE_NAMES = ["Raw", "Bitmap", "Deflate", "ImagePNG", "ImageJPEG"]
+
+# ft8xxmemory.h directory layout
+DIRECTORY_MAGIC = 0x41455645
+HEADER_SIZE = 16
+ENTRY_SIZE = 20
+ALIGN = 64    # CMD_FLASHREAD and CMD_FLASHSOURCE need 64 byte aligned flash address
+
+
+class Asset:
+    def __init__(self, name, data, kind, fmt, width, height, target):
+        self.name = name
+        self.data = data
+        self.kind = kind
+        self.fmt = fmt
+        self.width = width
+        self.height = height
+        self.target = target    # StoredObject subclass made from this asset
+        self.address = 0
+
+
+# ---------------- PNG ----------------
+def png_info(data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n" or data[12:16] != b"IHDR":
+        raise ValueError("not a PNG file")
+    width, height, depth, colour = struct.unpack(">IIBB", data[16:26])
+    return width, height, depth, colour
+
+
+def png_chunks(data):
+    i = 8
+    while i + 8 <= len(data):
+        length, kind = struct.unpack(">I4s", data[i:i + 8])
+        yield kind, data[i + 8:i + 8 + length]
+        i += length + 12
+
+
+def png_loadimage_format(data):
+    """Bitmap format CMD_LOADIMAGE gives for PNG, same as RamG::parsePNGHeader"""
+    colour = png_info(data)[3]
+    if colour == 0:
+        return FORMATS["L8"]
+    if colour == 2:
+        return FORMATS["RGB565"]
+    if colour in (4, 6):
+        return FORMATS["ARGB4"]
+    if colour == 3:
+        for kind, _ in png_chunks(data):
+            if kind == b"tRNS":
+                return FORMATS["PALETTED4444"]
+            if kind == b"IDAT":
+                break
+        return FORMATS["PALETTED565"]
+    raise ValueError("unsupported PNG colour type %d" % colour)
+
+
+def decode_png(data):
+    """Return width, height and list of (r, g, b, a)"""
+    try:
+        from PIL import Image
+        import io
+        image = Image.open(io.BytesIO(data)).convert("RGBA")
+        return image.width, image.height, list(image.getdata())
+    except ImportError:
+        pass
+
+    width, height, depth, colour = png_info(data)
+    if depth != 8 or data[28] != 0:
+        raise ValueError("built-in decoder supports only 8 bit not interlaced PNG, install Pillow")
+    palette, alpha, idat = [], b"", b""
+    for kind, body in png_chunks(data):
+        if kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            alpha = body
+        elif kind == b"IDAT":
+            idat += body
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colour]
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    pixels = []
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += stride + 1
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if colour == 0:
+                pixels.append((px[0], px[0], px[0], 255))
+            elif colour == 2:
+                pixels.append((px[0], px[1], px[2], 255))
+            elif colour == 3:
+                r, g, b = palette[px[0]]
+                pixels.append((r, g, b, alpha[px[0]] if px[0] < len(alpha) else 255))
+            elif colour == 4:
+                pixels.append((px[0], px[0], px[0], px[1]))
+            else:
+                pixels.append(tuple(px))
+        prev = line
+    return width, height, pixels
+
+
+# ---------------- conversion ----------------
+def rgb565(p):
+    return ((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3)
+
+
+def argb4(p):
+    return ((p[3] >> 4) << 12) | ((p[0] >> 4) << 8) | ((p[1] >> 4) << 4) | (p[2] >> 4)
+
+
+def argb1555(p):
+    return ((1 if p[3] >= 128 else 0) << 15) | ((p[0] >> 3) << 10) | ((p[1] >> 3) << 5) | (p[2] >> 3)
+
+
+def luminance(p):
+    return (p[0] * 299 + p[1] * 587 + p[2] * 114) // 1000
+
+
+def convert(pixels, fmt):
+    """Return bitmap data and palette (or None)"""
+    if fmt == "L8":
+        return bytes(luminance(p) for p in pixels), None
+    if fmt in ("RGB565", "ARGB4", "ARGB1555"):
+        pack = {"RGB565": rgb565, "ARGB4": argb4, "ARGB1555": argb1555}[fmt]
+        return b"".join(struct.pack("<H", pack(p)) for p in pixels), None
+
+    colours = sorted(set(pixels))
+    if len(colours) > 256:
+        raise ValueError("%d colours, paletted formats support 256" % len(colours))
+    index = {c: i for i, c in enumerate(colours)}
+    data = bytes(index[p] for p in pixels)
+    if fmt == "PALETTED565":
+        lut = b"".join(struct.pack("<H", rgb565(c)) for c in colours)
+    elif fmt == "PALETTED4444":
+        lut = b"".join(struct.pack("<H", argb4(c)) for c in colours)
+    else:    # PALETTED8: ARGB8 palette
+        lut = b"".join(struct.pack("<BBBB", c[2], c[1], c[0], c[3]) for c in colours)
+    return data, lut
+
+
+def bitmap_asset(name, data, fmt, width, height, target=None):
+    packed = zlib.compress(data, 9)
+    if len(packed) < len(data) * 0.8:
+        return Asset(name, packed, TYPE_DEFLATE, fmt, width, height,
+                     target or "EVE::CompressedImage")
+    return Asset(name, data, TYPE_BITMAP, fmt, width, height, target or "EVE::RawBitmap")
+
+
+def load_astc(name, data):
+    magic, bx, by, _, = struct.unpack("<IBBB", data[:7])
+    if magic != 0x5CA1AB13:
+        raise ValueError("not an ASTC file")
+    width = int.from_bytes(data[7:10], "little")
+    height = int.from_bytes(data[10:13], "little")
+    block = "%dx%d" % (bx, by)
+    if block not in ASTC_BLOCKS:
+        raise ValueError("ASTC block %s not supported by EVE" % block)
+    # Block data is used as astcenc wrote it
+    return Asset(name, data[16:], TYPE_BITMAP, ASTC_BASE + ASTC_BLOCKS.index(block),
+                 width, height, "EVE::FlashBitmap")
+
+
+def load_input(spec):
+    name, _, rest = spec.partition("=")
+    parts = rest.split(":")
+    path = parts[0]
+    fmt = parts[1].upper() if len(parts) > 1 else None
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:8] == b"\x89PNG\r\n\x1a\n":
+        width, height, _, _ = png_info(data)
+        if fmt in (None, "PNG"):
+            return [Asset(name, data, TYPE_PNG, png_loadimage_format(data), width, height,
+                          "EVE::ImagePNG")]
+        width, height, pixels = decode_png(data)
+        bitmap, lut = convert(pixels, fmt)
+        if lut is None:
+            return [bitmap_asset(name, bitmap, FORMATS[fmt], width, height)]
+        # Indices are loaded by RamG::loadPaletted, colour table by RamG::loadPalette
+        entries = len(lut) // (4 if fmt == "PALETTED8" else 2)
+        assets = [bitmap_asset(name, bitmap, FORMATS[fmt], width, height, "EVE::PalettedBitmap"),
+                  Asset(name + "_lut", lut, TYPE_RAW, FORMATS[fmt], entries, 1, "EVE::Palette")]
+        return assets
+
+    if data[:2] == b"\xff\xd8":
+        jpeg_fmt = FORMATS["L8"] if fmt == "L8" else FORMATS["RGB565"]
+        width, height = jpeg_size(data)
+        return [Asset(name, data, TYPE_JPEG, jpeg_fmt, width, height, "EVE::ImageJPEG")]
+
+    if path.lower().endswith(".astc"):
+        return [load_astc(name, data)]
+
+    if fmt not in FORMATS or len(parts) < 3:
+        raise ValueError("raw input needs FORMAT and WIDTHxHEIGHT")
+    width, height = (int(v) for v in parts[2].lower().split("x"))
+    return [bitmap_asset(name, data, FORMATS[fmt], width, height)]
+
+
+def jpeg_size(data):
+    i = 2
+    while i + 9 < len(data):
+        marker = data[i + 1]
+        if marker in (0xC0, 0xC1):
+            height, width = struct.unpack(">HH", data[i + 5:i + 9])
+            return width, height
+        if marker == 0xC2:
+            raise ValueError("progressive JPEG is not supported by CMD_LOADIMAGE")
+        i += struct.unpack(">H", data[i + 2:i + 4])[0] + 2
+    raise ValueError("JPEG SOF marker not found")
+
+
+# ---------------- output ----------------
+def align(value, to=ALIGN):
+    return (value + to - 1) & ~(to - 1)
+
+
+def pack(assets, base):
+    offset = align(HEADER_SIZE + ENTRY_SIZE * len(assets))
+    for a in assets:
+        a.address = base + offset
+        offset = align(offset + len(a.data))
+
+    blob = bytearray(offset)
+    struct.pack_into("<IIII", blob, 0, DIRECTORY_MAGIC, len(assets), 0, 0)
+    for i, a in enumerate(assets):
+        struct.pack_into("<IIIHHHH", blob, HEADER_SIZE + i * ENTRY_SIZE,
+                         i + 1, a.address, align(len(a.data), 4),
+                         a.kind, a.fmt, a.width, a.height)
+        start = a.address - base
+        blob[start:start + len(a.data)] = a.data
+    return bytes(blob)
+
+
+def header(assets, base, blob_size):
+    lines = ["// Generated by eve_asset_pack.py. Do not edit",
+             "#pragma once",
+             "#include <ft8xxmemory.h>",
+             "",
+             "namespace Assets",
+             "{",
+             "#if defined(BT81X_ENABLE)",
+             "constexpr uint32_t blobAddress = %#x;" % base,
+             "constexpr uint32_t blobSize    = %d;" % blob_size,
+             ""]
+    for i, a in enumerate(assets):
+        lines.append("//%s: %dx%d -> %s" % (a.name, a.width, a.height, a.target))
+        lines.append("constexpr EVE::FlashAsset %s{%d, %#x, %d, EVE::FlashAssetType::%s, %d, %d, %d};"
+                     % (a.name, i + 1, a.address, align(len(a.data), 4), TYPE_NAMES[a.kind],
+                        a.fmt, a.width, a.height))
+    lines += ["#endif", "}    // namespace Assets", ""]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack images to EVE flash blob")
+    parser.add_argument("inputs", nargs="+", help="NAME=PATH[:FORMAT[:WIDTHxHEIGHT]]")
+    parser.add_argument("-o", "--output", required=True, help="blob file")
+    parser.add_argument("--header", help="generated C++ header")
+    parser.add_argument("--base", type=lambda v: int(v, 0), default=0x1000,
+                        help="flash address of blob (default 0x1000). Other address must be "
+                             "passed to FT8xx::flashInit")
+    args = parser.parse_args()
+
+    if args.base % 4096 != 0:
+        parser.error("base must be 4096 byte aligned for CMD_FLASHUPDATE")
+
+    assets = []
+    for spec in args.inputs:
+        try:
+            assets += load_input(spec)
+        except (ValueError, OSError) as e:
+            print("%s: %s" % (spec, e), file=sys.stderr)
+            return 1
+
+    blob = pack(assets, args.base)
+    with open(args.output, "wb") as f:
+        f.write(blob)
+    if args.header:
+        with open(args.header, "w") as f:
+            f.write(header(assets, args.base, len(blob)))
+
+    for a in assets:
+        print("%-20s %-10s %6d bytes at %#08x" % (a.name, TYPE_NAMES[a.kind], len(a.data), a.address))
+    print("%s: %d bytes" % (os.path.basename(args.output), len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
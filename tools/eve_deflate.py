@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+eve_deflate - compress raw bitmap data for RamG::inflate (CMD_INFLATE / CMD_INFLATE2).
+
+Input is raw bitmap data already in EVE format (RGB565, ARGB4, L8, ...).
+Output is zlib stream as binary file or as C array ready to include to firmware.
+
+Usage:
+    eve_deflate.py input.raw output.bin
+    eve_deflate.py input.raw output.h --name backgroundImage
+"""
+
+import argparse
+import os
+import sys
+import zlib
+
+
+def to_c_array(name, data):
+    lines = ["// Generated by eve_deflate.py. Do not edit",
+             "#pragma once",
+             "#include <stdint.h>",
+             "",
+             "static const uint32_t %s_size = %d;" % (name, len(data)),
+             "static const uint8_t %s[] = {" % name]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compress raw bitmap for EVE CMD_INFLATE")
+    parser.add_argument("input", help="raw bitmap data")
+    parser.add_argument("output", help="output file (.h for C array, binary otherwise)")
+    parser.add_argument("--name", help="C array name (default: output file name)")
+    parser.add_argument("--level", type=int, default=9, help="zlib compression level")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        raw = f.read()
+    packed = zlib.compress(raw, args.level)
+
+    if args.output.endswith(".h"):
+        name = args.name or os.path.splitext(os.path.basename(args.output))[0]
+        with open(args.output, "w") as f:
+            f.write(to_c_array(name, packed))
+    else:
+        with open(args.output, "wb") as f:
+            f.write(packed)
+
+    ratio = len(raw) / len(packed) if packed else 0
+    print("%s: %d -> %d bytes (%.1fx)" % (args.input, len(raw), len(packed), ratio))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())